@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+
+# extensive, but scalable, view of the DMPlex underlying a Firedrake mesh;
+# statistics are computed with parallel reductions and only rank 0 prints,
+# while the optional full dump goes to one binary (.npz) file per rank
+# for example:
+#   $ mpiexec -n 4 ./moredmview.py -refine 6 -dump plex
+# or, to view the mesh in fish.py, add these lines after the mesh is built:
+#   from solns.moredmview import moredmview
+#   moredmview(mesh)
+
+from argparse import ArgumentParser, RawTextHelpFormatter
+import numpy as np
+from firedrake import *
+from firedrake.petsc import PETSc
+from mpi4py import MPI
+
+def histogram(comm, values, length):
+    '''Global histogram of nonnegative integer values.'''
+    local = np.bincount(np.asarray(values, dtype=int), minlength=length)[:length]
+    return comm.allreduce(local, op=MPI.SUM)
+
+def summary(comm, x):
+    '''Global (min, mean, max) of a local quantity.'''
+    return (comm.allreduce(x, op=MPI.MIN),
+            comm.allreduce(x, op=MPI.SUM) / comm.size,
+            comm.allreduce(x, op=MPI.MAX))
+
+def moredmview(mesh, dump=''):
+    '''Print global statistics of mesh.topology_dm:  stratum sizes, cone-size
+    histograms, cell quality, and ghost ratios, each as totals or as
+    (min, mean, max) over ranks.  If dump is nonempty then each rank writes
+    its coordinates, cones, and ghost marks to dump.rank<r>.npz.'''
+    comm, plex = mesh.comm, mesh.topology_dm
+    dim = plex.getDimension()
+    pStart, pEnd = plex.getChart()
+    _, ilocal, iremote = plex.getPointSF().getGraph()
+    ghost = np.zeros(pEnd - pStart, dtype=bool)
+    if ilocal is None:
+        ilocal = np.arange(len(iremote)) + pStart
+    ghost[np.asarray(ilocal, dtype=int) - pStart] = True
+    PETSc.Sys.Print('DMPlex of dimension %d on %d processes:' % (dim,comm.size))
+    cones = {}
+    for depth in range(dim+1):
+        start, end = plex.getDepthStratum(depth)
+        owned = np.count_nonzero(~ghost[start-pStart:end-pStart])
+        nmin, nmean, nmax = summary(comm, owned)
+        PETSc.Sys.Print('  depth %d stratum: %d owned points; per rank min/mean/max = %d/%.1f/%d' \
+                        % (depth,comm.allreduce(owned, op=MPI.SUM),nmin,nmean,nmax))
+        if depth > 0:
+            sizes = np.array([plex.getConeSize(p) for p in range(start,end)
+                              if not ghost[p-pStart]], dtype=int)
+            hist = histogram(comm, sizes, 9)
+            PETSc.Sys.Print('    cone-size histogram: %s' \
+                            % ', '.join('%d:%d' % (k,n) for k, n in enumerate(hist) if n > 0))
+            if len(dump) > 0:
+                cones[depth] = [plex.getCone(p) for p in range(start,end)]
+    # ghost ratio is ghost points / owned points on each rank
+    nghost = np.count_nonzero(ghost)
+    gmin, gmean, gmax = summary(comm, nghost / max(pEnd - pStart - nghost, 1))
+    PETSc.Sys.Print('  ghost/owned points per rank min/mean/max = %.3f/%.3f/%.3f' \
+                    % (gmin,gmean,gmax))
+    # shape quality is volume / diameter^dim, normalized to one on equilateral
+    # triangles and squares
+    if mesh.ufl_cell().cellname() == 'quadrilateral':
+        scale = 2.0
+    else:
+        scale = 4.0 / np.sqrt(3.0)
+    DG0 = FunctionSpace(mesh, 'DG', 0)
+    v = TestFunction(DG0)
+    ratio = scale * CellVolume(mesh) / CellDiameter(mesh)**dim
+    quality = assemble(ratio * v * dx).dat.data_ro / assemble(v * dx).dat.data_ro
+    qmin = comm.allreduce(quality.min() if len(quality) > 0 else np.inf, op=MPI.MIN)
+    qmax = comm.allreduce(quality.max() if len(quality) > 0 else -np.inf, op=MPI.MAX)
+    qmean = comm.allreduce(quality.sum(), op=MPI.SUM) \
+            / max(comm.allreduce(len(quality), op=MPI.SUM), 1)
+    hist = histogram(comm, np.minimum(10 * quality, 9.0).astype(int), 10)
+    PETSc.Sys.Print('  cell quality (1 is best) min/mean/max = %.3f/%.3f/%.3f' \
+                    % (qmin,qmean,qmax))
+    PETSc.Sys.Print('    quality histogram (bins of 0.1): %s' \
+                    % ' '.join('%d' % n for n in hist))
+    if len(dump) > 0:
+        name = '%s.rank%d.npz' % (dump,comm.rank)
+        conedata = {}
+        for depth, cl in cones.items():
+            conedata['cone_offsets_%d' % depth] = np.cumsum([0,] + [len(c) for c in cl])
+            conedata['cones_%d' % depth] = np.concatenate(cl) if len(cl) > 0 \
+                                           else np.zeros(0, dtype=int)
+        np.savez(name, chart=np.array([pStart,pEnd]), ghost=ghost,
+                 coordinates=plex.getCoordinatesLocal().array,
+                 depth_strata=np.array([plex.getDepthStratum(d) for d in range(dim+1)]),
+                 **conedata)
+        PETSc.Sys.Print('  full dump written to %s.rank*.npz' % dump)
+
+if __name__ == '__main__':
+    parser = ArgumentParser(description="""
+Scalable statistics of the DMPlex underlying a Firedrake mesh, either a
+uniform mesh of the unit square as in fish.py, or read from a Gmsh file.
+Use -help for PETSc options and -dmviewhelp for options to moredmview.py.""",
+        formatter_class=RawTextHelpFormatter,add_help=False)
+    parser.add_argument('-dmviewhelp', action='store_true', default=False,
+                        help='help for moredmview.py options')
+    parser.add_argument('-dump', metavar='PREFIX', type=str, default='',
+                        help='write full dump to PREFIX.rank<r>.npz files')
+    parser.add_argument('-mesh', metavar='INNAME', type=str, default='',
+                        help='input file for mesh in Gmsh format (.msh)')
+    parser.add_argument('-mx', type=int, default=3, metavar='MX',
+                        help='number of grid points in x-direction')
+    parser.add_argument('-my', type=int, default=3, metavar='MY',
+                        help='number of grid points in y-direction')
+    parser.add_argument('-quad', action='store_true', default=False,
+                        help='use quadrilateral cells')
+    parser.add_argument('-refine', type=int, default=-1, metavar='X',
+                        help='number of refinement levels')
+    args, unknown = parser.parse_known_args()
+    if args.dmviewhelp:
+        parser.print_help()
+    if len(args.mesh) > 0:
+        mesh = Mesh(args.mesh)
+    else:
+        mesh = UnitSquareMesh(args.mx-1, args.my-1, quadrilateral=args.quad)
+    if args.refine > 0:
+        mesh = MeshHierarchy(mesh, args.refine)[-1]
+    moredmview(mesh, dump=args.dump)
@@ -15,17 +15,29 @@ function runcase() {
     grep -A 3 "Mat Object: (s_)" tmp.txt | grep "rows"
     grep -A 3 "Mat Object: (s_)" tmp.txt | grep "total:"
     grep "Flop:    " tmp.txt
+    grep "fill ratio given" tmp.txt || true
+    grep -E "^(PCSetUp|PCApply) " tmp.txt
 }
 
-# h refine
+# h refine; -s_ksp_rtol 1.0e-14 over-solves on coarse levels, for which
+# compare "-discstop 0.1 -discstopcompare"
 for L in 1 2 3 4 5 6 7 8 9; do
      runcase $L 1 "-s_ksp_type cg -s_pc_type mg -s_ksp_rtol 1.0e-14"
 done
 
-# p refine
+# p refine; on quadrilaterals compare the fast-diagonalization exact inverse,
+#   runcase 1 $P "-quad -s_ksp_type cg -fdm global"
+# or, on finer grids, CG+GMG with vertex-star FDM smoothing,
+#   runcase 4 $P "-quad -s_ksp_type cg -fdm star"
 for P in 1 2 3 4 5 6 7 8; do
      runcase 1 $P "-s_ksp_type preonly -s_pc_type cholesky"
 done
 
+# p refine with static condensation of cell-interior DOFs (triangles have
+# these only for P >= 3); compare factor fill and PCSetUp time above
+for P in 3 4 5 6 7 8; do
+     runcase 1 $P "-s_ksp_type cg -sc cholesky"
+done
+
 rm -rf tmp.txt
 
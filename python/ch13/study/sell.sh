@@ -0,0 +1,29 @@
+#!/bin/bash
+set -e
+set +x
+
+# run as
+#    ./sell.sh &> sell.txt
+
+# compare MatMult throughput (DOF/s, GB/s) of AIJ and SELL (sliced ELLPACK)
+# copies of the operator on each level of the GMG hierarchy, then compare
+# CG+GMG solves with the default smoother and with Chebyshev+Jacobi on SELL
+# copies of the level operators; for the velocity block in stokes.py see
+#    ../../ch14/stokes.py -refine 6 -sellreport
+#    ../../ch14/stokes.py -refine 6 -schurgmg lower -gmgsmoother sell
+
+for K in 1 2 3; do
+    CMD="../fish.py -refine 7 -k $K -sellreport -s_ksp_type preonly -s_pc_type none"
+    echo "COMMAND:  $CMD"
+    $CMD | grep -E "^  (level| +[0-9])"
+    for SELL in "" "-sell"; do
+        CMD="../fish.py -refine 7 -k $K $SELL -s_pc_type mg -s_ksp_converged_reason -log_view"
+        echo "COMMAND:  $CMD"
+        $CMD &> tmp.txt
+        grep "CONVERGED" tmp.txt
+        grep "^KSPSolve" tmp.txt
+        grep "^MatMult " tmp.txt
+    done
+done
+
+rm -rf tmp.txt
@@ -0,0 +1,37 @@
+#!/bin/bash
+set -e
+set +x
+
+# run as
+#    ./sumfact.sh &> sumfact.txt
+
+# compare assembly throughput (cells/s) of the residual, the Jacobian, and the
+# operator action (as used by -matfree) for Q_k, k = 1..8, between the
+# "vanilla" mode kernels, which do not sum-factorize, and the kernels of
+# TSFC's default "spectral" mode, which do; the mesh is 128 x 128 cells; the
+# degree is fixed at 2k, what the Laplacian needs, so both modes use the
+# same quadrature ("tensor" mode does not support Q_k)
+
+for K in 1 2 3 4 5 6 7 8; do
+    for MODE in "-formmode vanilla" ""; do
+        CMD="../fish.py -quad -refine 6 -k $K -qdegree $(( 2 * K )) $MODE -formreport -s_ksp_type preonly -s_pc_type none"
+        echo "COMMAND:  $CMD"
+        $CMD | grep "form "
+    done
+done
+
+# then compare matrix-free CG+GMG, which uses the sum-factorized action,
+# against assembled CG+GMG at high degree
+for K in 4 8; do
+    for MF in "" "-matfree"; do
+        CMD="../fish.py -quad -refine 6 -k $K $MF -s_pc_type mg -s_ksp_converged_reason -log_view"
+        echo "COMMAND:  $CMD"
+        $CMD &> tmp.txt
+        grep "CONVERGED" tmp.txt
+        grep "error " tmp.txt
+        grep "^KSPSolve" tmp.txt
+        grep "^MatMult " tmp.txt
+    done
+done
+
+rm -rf tmp.txt
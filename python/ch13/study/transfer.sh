@@ -0,0 +1,20 @@
+#!/bin/bash
+set -e
+set +x
+
+# run as
+#    ./transfer.sh &> transfer.txt
+
+# compare GMG prolongation and restriction, per level, by Firedrake's
+# matrix-free interpolation kernels and by SpMV with assembled (AIJ) transfer
+# matrices, for low and high degree; the setup column is the one-time cost of
+# building each P; for the velocity space in stokes.py see
+#    ../../ch14/stokes.py -refine 6 -schurgmg lower -transfer assembled
+
+for K in 1 2 3 4; do
+    for TRANSFER in matfree assembled; do
+        CMD="../fish.py -refine 7 -k $K -s_pc_type mg -s_ksp_converged_reason -transfer $TRANSFER"
+        echo "COMMAND:  $CMD"
+        $CMD | grep -E "CONVERGED|transfers|^ +[0-9]+ +[0-9]+ "
+    done
+done
@@ -0,0 +1,22 @@
+#!/bin/bash
+set -e
+set +x
+
+# run as
+#    ./vectorize.sh &> vectorize.txt
+
+# compare assembly throughput (cells/s) of the residual, the Jacobian, and the
+# operator action for P1..P4 and Q1..Q4 on a 256 x 256 cell mesh, with kernels
+# called one cell at a time (none) or vectorized across 4 (avx2) or 8
+# (avx512) cells; use only widths the processor supports; stokes.py has the
+# same -vectorize and -formreport options
+
+for CELL in "" "-quad"; do
+    for K in 1 2 3 4; do
+        for VEC in none avx2 avx512; do
+            CMD="../fish.py $CELL -refine 7 -k $K -vectorize $VEC -formreport -s_ksp_type preonly -s_pc_type none"
+            echo "COMMAND:  $CMD"
+            $CMD | grep "form "
+        done
+    done
+done
@@ -3,6 +3,7 @@
 from argparse import ArgumentParser, RawTextHelpFormatter
 from datetime import datetime
 import sys, platform
+from meshgrading import gradedsegment
 
 parser = ArgumentParser(description="""
 Generate .geo file for Gmsh to generate a mesh on the unit square.
@@ -16,8 +17,14 @@ parser.add_argument('-cl', type=float, default=0.1, metavar='CL',
                     help='characteristic length for most of boundary (default=0.1)')
 parser.add_argument('-cornerrefine', type=float, default=100, metavar='X',
                     help='ratio of refinement in corners (default=100)')
+parser.add_argument('-quad', action='store_true', default=False,
+                    help='recombine triangles into an all-quadrilateral mesh;\n'
+                         'use with stokes.py -quad')
 parser.add_argument('-quiet', action='store_true', default=False,
                     help='suppress all stdout')
+parser.add_argument('-transfinite', action='store_true', default=False,
+                    help='structured (transfinite) mesh, geometrically graded toward\n'
+                         'lower corners; gives quadrilaterals if combined with -quad')
 parser.add_argument('-usenames', action='store_true', default=False,
                     help='put names "dirichlet","neumann","interior" in PhysicalNames() ... used only for running through c/ch10/vis/petsc2tikz.py')
 args = parser.parse_args()
@@ -74,6 +81,28 @@ geo.write('cleddy = %f;  // characteristic length for corners (%g times smaller)
           % (args.cl/args.cornerrefine,args.cornerrefine))
 geo.write('trans = 0.4;  // location of transition\n')
 geo.write(meat)
+if args.transfinite:
+    # opposite sides need equal node counts:  left = (10,11), right = (15,16),
+    # bottom = (12,13,14), top = (17); segments touching a lower corner
+    # shrink geometrically toward it from size cl to size cleddy
+    nc, q = gradedsegment(0.4, args.cl, args.cornerrefine)
+    nmid = max(1, int(round(0.6/args.cl)))
+    nbot = max(1, int(round(0.2/args.cl)))
+    geo.write('''
+// structured mesh graded toward lower corners
+Transfinite Line{10,16} = %d;
+Transfinite Line{11,14} = %d Using Progression %f;   // toward corner
+Transfinite Line{12,15} = %d Using Progression %f;   // away from corner
+Transfinite Line{13} = %d;
+Transfinite Line{17} = %d;
+Transfinite Surface{30} = {1,3,6,8};\n''' \
+              % (nmid+1, nc+1, q, nc+1, 1.0/q, nbot+1, 2*nc+nbot+1))
+if args.quad:
+    geo.write('''
+// all-quadrilateral mesh
+Recombine Surface{30};
+Mesh.RecombinationAlgorithm = 3;  // blossom full-quad
+Mesh.Algorithm = 8;               // frontal-Delaunay for quads\n''')
 if args.usenames:
     geo.write(physnames)
 else:
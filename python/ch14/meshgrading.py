@@ -0,0 +1,15 @@
+'''Geometric grading of boundary segments for the Gmsh .geo generators
+lidbox.py and solns/angle.py.'''
+
+def gradedsegment(L, h, ratio):
+    '''Number of elements n and geometric progression q so that n elements,
+    starting from size h and shrinking by factor q each time down to size
+    h/ratio, cover a segment of length L.'''
+    if ratio <= 1.0:
+        return max(1, int(round(L/h))), 1.0
+    n = 1
+    while True:
+        n += 1
+        q = ratio**(-1.0/(n-1))
+        if h * (1.0 - q**n) / (1.0 - q) >= L:
+            return n, q
@@ -8,10 +8,15 @@
 #   $ gmsh -2 wedge.geo
 #   $ ../stokes.py -mesh wedge.msh -o wedge.pvd -s_ksp_converged_reason -dm_view -s_pc_type lu -s_mat_type aij -s_pc_factor_shift_type inblocks -s_ksp_type preonly -udegree 4 -pdegree 3 -refine 2
 
+# to sweep many angles without regenerating the mesh, morph the coordinates of
+# one reference wedge mesh; see anglesweep.py
+
 from argparse import ArgumentParser, RawTextHelpFormatter
 from datetime import datetime
 import numpy as np
-import sys, platform
+import sys, os, platform
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+from meshgrading import gradedsegment   # shared with lidbox.py
 
 parser = ArgumentParser(description="""
 Generate .geo file for a triangular domain, a wedge, with controllable base angle.
@@ -25,8 +30,15 @@ parser.add_argument('-cl', type=float, default=0.2, metavar='CL',
                     help='characteristic length for top (default=0.2)')
 parser.add_argument('-cornerrefine', type=float, default=200, metavar='X',
                     help='ratio of refinement in corners (default=200)')
+parser.add_argument('-quad', action='store_true', default=False,
+                    help='recombine triangles into an all-quadrilateral mesh;\n'
+                         'use with stokes.py -quad')
 parser.add_argument('-quiet', action='store_true', default=False,
                     help='suppress all stdout')
+parser.add_argument('-transfinite', action='store_true', default=False,
+                    help='geometric node distribution on the sides, graded toward\n'
+                         'the bottom corner; the interior stays unstructured, as\n'
+                         'a structured mesh of a triangle has a degenerate corner')
 parser.add_argument('-usenames', action='store_true', default=False,
                     help='put names "dirichlet","neumann","interior" in PhysicalNames() ... used only for running through c/ch10/vis/petsc2tikz.py')
 args = parser.parse_args()
@@ -74,6 +86,21 @@ geo.write('cl = %f;   // characteristic length\n' % args.cl)
 geo.write('cleddy = %f;  // characteristic length for corner (%g times smaller)\n' \
           % (args.cl/args.cornerrefine,args.cornerrefine))
 geo.write(meat)
+if args.transfinite:
+    # side lines are 10 (1->2, toward bottom) and 11 (2->3, away from bottom)
+    nside, q = gradedsegment(np.sqrt(0.25 + topy**2), args.cl, args.cornerrefine)
+    geo.write('''
+// node distributions graded toward bottom corner
+Transfinite Line{10} = %d Using Progression %f;   // toward corner
+Transfinite Line{11} = %d Using Progression %f;   // away from corner
+Transfinite Line{12} = %d;\n''' \
+              % (nside+1, q, nside+1, 1.0/q, max(1, int(round(1.0/args.cl)))+1))
+if args.quad:
+    geo.write('''
+// all-quadrilateral mesh
+Recombine Surface{30};
+Mesh.RecombinationAlgorithm = 3;  // blossom full-quad
+Mesh.Algorithm = 8;               // frontal-Delaunay for quads\n''')
 if args.usenames:
     geo.write(physnames)
 else:
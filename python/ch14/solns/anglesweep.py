@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+
+# companion to angle.py for exercise 14.16:  sweep the base angle of the wedge
+# WITHOUT regenerating the mesh; one reference wedge mesh (and its hierarchy)
+# is read once and, for each angle, only the vertex coordinates are morphed
+# for example, generate a reference mesh at 130^o and sweep from 100^o to 150^o:
+#   $ ./angle.py -angle 130 -cornerrefine 2000 wedge.geo
+#   $ gmsh -2 wedge.geo
+#   $ ./anglesweep.py -mesh wedge.msh -refangle 130 -angles 100:150:11 -refine 2 -o wedge.pvd
+
+# the wedge generated by angle.py has vertices (0,topy), (0.5,0), (1,topy)
+# with topy = 0.5 / tan(theta/2), so changing the base angle theta is the
+# affine map  y -> (topy(theta) / topy(theta_ref)) y.  Because the map is
+# affine the mesh topology, DOF maps, sparsity patterns, compiled kernels and
+# the solver (including its GMG hierarchy) are all reused; each angle costs
+# only reassembly and a numerical solve.
+
+from argparse import ArgumentParser, RawTextHelpFormatter
+import numpy as np
+from firedrake import *
+from firedrake.petsc import PETSc
+
+parser = ArgumentParser(description="""
+Solve the lid-driven Stokes problem on a sweep of wedge domains obtained by
+morphing the coordinates of one reference wedge mesh from angle.py.  Uses
+P^k x P^l Taylor-Hood elements.  The default solver is a direct solver;
+the prefix for PETSC solver options is 's_'.  Use -help for PETSc options and
+-sweephelp for options to anglesweep.py.""",
+    formatter_class=RawTextHelpFormatter,add_help=False)
+parser.add_argument('-angles', metavar='A0:A1:N', type=str, default='',
+                    help='sweep N base angles in degrees from A0 to A1 (inclusive),\n'
+                         'or comma-separated list of angles (default=REFANGLE only)')
+parser.add_argument('-mesh', metavar='INNAME', type=str, default='wedge.msh',
+                    help='reference wedge mesh in Gmsh format from angle.py\n'
+                         '(default=wedge.msh)')
+parser.add_argument('-o', metavar='OUTNAME', type=str, default='',
+                    help='output file name for Paraview format (.pvd); one time\n'
+                         'step per angle')
+parser.add_argument('-pdegree', type=int, default=1, metavar='L',
+                    help='polynomial degree for pressure (default=1)')
+parser.add_argument('-refangle', type=float, default=28.1, metavar='X',
+                    help='base angle in degrees used for -angle in angle.py\n'
+                         '(default=28.1)')
+parser.add_argument('-refine', type=int, default=0, metavar='R',
+                    help='number of refinement levels (e.g. for GMG)')
+parser.add_argument('-sweephelp', action='store_true', default=False,
+                    help='help for anglesweep.py options')
+parser.add_argument('-udegree', type=int, default=2, metavar='K',
+                    help='polynomial degree for velocity (default=2)')
+args, unknown = parser.parse_known_args()
+if args.sweephelp:
+    parser.print_help()
+
+def topy(angle):
+    '''Height of wedge top, of width 1.0, with base angle in degrees.'''
+    theta = 0.5 * (np.pi/180.0) * angle  # half angle at base of wedge
+    return 0.5 / np.tan(theta)
+
+if len(args.angles) == 0:
+    angles = [args.refangle,]
+elif ':' in args.angles:
+    a0, a1, n = args.angles.split(':')
+    angles = list(np.linspace(float(a0), float(a1), int(n)))
+else:
+    angles = [float(a) for a in args.angles.split(',')]
+assert all(0.0 < a < 180.0 for a in angles), 'angles must be in (0,180)'
+
+# read reference mesh once; keep the whole hierarchy and the reference
+# y-coordinates of every level
+PETSc.Sys.Print('reading reference wedge mesh (base angle %.1f) from %s ...' \
+                % (args.refangle,args.mesh))
+mesh = Mesh(args.mesh)
+if args.refine > 0:
+    hierarchy = MeshHierarchy(mesh, args.refine)
+    mesh = hierarchy[-1]     # the fine mesh
+    levels = list(hierarchy)
+else:
+    levels = [mesh,]
+yref = [m.coordinates.dat.data_ro[:,1].copy() for m in levels]
+other = (41,)
+lid = (40,)
+
+# mixed space, boundary conditions and weak form are built once; compare
+# stokes.py (default lid-driven cavity problem)
+x,y = SpatialCoordinate(mesh)
+V = VectorFunctionSpace(mesh, 'CG', degree=args.udegree)
+W = FunctionSpace(mesh, 'CG', degree=args.pdegree)
+Z = V * W
+u_lid = Function(V)
+bcs = [ DirichletBC(Z.sub(0), Constant((0.0, 0.0)), other),
+        DirichletBC(Z.sub(0), u_lid, lid) ]
+ns = MixedVectorSpaceBasis(Z, [Z.sub(0), VectorSpaceBasis(constant=True)])
+up = Function(Z)
+u,p = split(up)
+v,q = TestFunctions(Z)
+Du = 0.5 * (grad(u)+grad(u).T)
+Dv = 0.5 * (grad(v)+grad(v).T)
+F = (2.0 * inner(Du,Dv) - p * div(v) - div(u) * q) * dx
+
+# one solver object, hence one set of kernels, sparsity patterns and PC
+# structure, for the whole sweep
+problem = NonlinearVariationalProblem(F, up, bcs=bcs)
+solver = NonlinearVariationalSolver(problem, nullspace=ns, options_prefix='s',
+             solver_parameters={'snes_type': 'ksponly',
+                                'ksp_type': 'preonly',
+                                'pc_type': 'lu',
+                                'mat_type': 'aij',
+                                'pc_factor_shift_type': 'inblocks'})
+
+if len(args.o) > 0:
+    outfile = File(args.o)
+PETSc.Sys.Print('sweeping %d angles with P_%d x P_%d elements (N = %d) ...' \
+                % (len(angles),args.udegree,args.pdegree,Z.dim()))
+for angle in angles:
+    # morph every level of the hierarchy with the same affine map
+    scale = topy(angle) / topy(args.refangle)
+    for m, yr in zip(levels, yref):
+        m.coordinates.dat.data[:,1] = scale * yr
+    # the lid is the line y = topy, 0 <= x <= 1, so its velocity is unchanged
+    # by the map, but re-interpolate anyway to stay correct for other maps
+    u_lid.interpolate(as_vector([x * (1.0 - x),0.0]))
+    up.assign(0.0)
+    solver.solve()
+    uu,pp = up.split()
+    uL2 = sqrt(assemble(dot(uu, uu) * dx))
+    pL2 = sqrt(assemble(dot(pp, pp) * dx))
+    PETSc.Sys.Print('  angle %6.2f (topy = %.4f): %d KSP iterations, |u|_h = %.2e, |p|_h = %.2e' \
+                    % (angle,topy(angle),solver.snes.getKSP().getIterationNumber(),uL2,pL2))
+    if len(args.o) > 0:
+        uu.rename('velocity')
+        pp.rename('pressure')
+        outfile.write(uu,pp,time=angle)
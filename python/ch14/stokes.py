@@ -1,9 +1,18 @@
 #!/usr/bin/env python3
 
-import sys
+import sys, os, json
+import numpy as np
 from argparse import ArgumentParser, RawTextHelpFormatter
 from firedrake import *
 from firedrake.petsc import PETSc
+from mpi4py import MPI
+
+# performance tools shared with ch13/fish.py; see ../perftools.py
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+from perftools import entitycounts, countdofs, countnonzeros, \
+    dryrunreport, formparameters, formreport, sellreport, reductiontiming, \
+    discstoptest, discstopsolve, haloreport, vectorize, telescope, \
+    distributionparameters, timedtransfer
 
 parser = ArgumentParser(description="""
 Solve a linear Stokes problem in 2D, an example of a saddle-point system.
@@ -22,8 +31,59 @@ PETSc options and -stokeshelp for options to stokes.py.""",
 
 parser.add_argument('-analytical', action='store_true', default=False,
                     help='Stokes problem with exact solution')
+parser.add_argument('-baij', action='store_true', default=False,
+                    help='assemble as MatNest with BAIJ blocks, so the velocity\n'
+                         'block has block size 2 (requires -schurgmg)')
+parser.add_argument('-baijreport', action='store_true', default=False,
+                    help='compare AIJ and BAIJ velocity blocks:  index storage and\n'
+                         'MatMult bandwidth')
+parser.add_argument('-calibrate', metavar='TA,TS', type=str, default='2.0e-8,2.0e-6',
+                    help='for -dryrun: seconds per assembled nonzero and per solved\n'
+                         'DOF (calibrate with -log_view on a small run;\n'
+                         'default=2.0e-8,2.0e-6)')
+parser.add_argument('-dryrun', action='store_true', default=False,
+                    help='predict sizes, nonzeros, memory, time from coarse mesh')
+parser.add_argument('-dryrunnp', type=int, default=0, metavar='P',
+                    help='for -dryrun: processes to predict for (default=current)')
+parser.add_argument('-autotune', action='store_true', default=False,
+                    help='probe all Schur+GMG packages and store the fastest\n'
+                         '(see -schurgmg auto)')
+parser.add_argument('-autotunedb', metavar='FILE', type=str,
+                    default=os.path.expanduser('~/.stokes-autotune.json'),
+                    help='database of autotuned packages\n'
+                         '(default=~/.stokes-autotune.json)')
+parser.add_argument('-autotunelevel', type=int, default=1, metavar='L',
+                    help='for -autotune: probe on level L of the hierarchy\n'
+                         '(default=1; at most -refine)')
+parser.add_argument('-discstop', type=float, default=0.0, metavar='FRAC',
+                    help='stop Krylov iteration when estimated algebraic error in\n'
+                         'velocity is below FRAC times estimated discretization\n'
+                         'error (requires -refine > 0)')
+parser.add_argument('-discstopcompare', action='store_true', default=False,
+                    help='for -discstop: also solve with -s_ksp_rtol, report savings')
 parser.add_argument('-dp', action='store_true', default=False,
                     help='use discontinuous-Galerkin finite elements for pressure')
+parser.add_argument('-errorquad', action='store_true', default=False,
+                    help='for -analytical: evaluate exact solution at quadrature\n'
+                         'points, without interpolating into degree K+2 and L+2\n'
+                         'spaces')
+parser.add_argument('-formmode', metavar='X', type=str, default='',
+                    help='TSFC form compiler mode for residual and Jacobian:\n'
+                         'vanilla|tensor|spectral (default=spectral, which\n'
+                         'sum-factorizes on -quad; tensor only without -quad)')
+parser.add_argument('-formreport', action='store_true', default=False,
+                    help='report estimated quadrature degree, points, and assembly\n'
+                         'time per form')
+parser.add_argument('-gmgsmoother', metavar='X', default='point',
+                    help='smoother in GMG for velocity block (with -schurgmg):\n'
+                         'point|line|star|sell')
+parser.add_argument('-grade', type=float, default=0.0, metavar='R',
+                    help='geometric grading of uniform grid toward lower corners;\n'
+                         'cells at corners are R times smaller (uniform case with\n'
+                         '-quad; R>1)')
+parser.add_argument('-haloreport', action='store_true', default=False,
+                    help='report core/owned/ghost sizes, and halo wait in assembly\n'
+                         'and MatMult')
 parser.add_argument('-lidscale', type=float, default=1.0, metavar='X',
                     help='scale for lid velocity (rightward positive; default=1.0)')
 parser.add_argument('-mesh', metavar='INNAME', type=str, default='',
@@ -38,24 +98,55 @@ parser.add_argument('-nobase', action='store_true', default=False,
                     help='Stokes problem with stress-free boundary condition on base')
 parser.add_argument('-o', metavar='OUTNAME', type=str, default='',
                     help='output file name for Paraview format (.pvd)')
+parser.add_argument('-partitioner', metavar='X', type=str, default='',
+                    help='mesh partitioner, e.g. parmetis|ptscotch|chaco|simple;\n'
+                         'parmetis minimizes edge cut, which grows the core fraction')
+parser.add_argument('-partition_report', action='store_true', default=False,
+                    help='print edge cut, neighbors, owned and ghost DOFs per rank')
+parser.add_argument('-partition_weighted', action='store_true', default=False,
+                    help='partition cells weighted by their DOF share and\n'
+                         'assembly cost')
 parser.add_argument('-pdegree', type=int, default=1, metavar='L',
                     help='polynomial degree for pressure (default=1)')
+parser.add_argument('-qdegree', type=int, default=-1, metavar='Q',
+                    help='quadrature degree for residual and Jacobian\n'
+                         '(default=estimated; -analytical forcing raises the\n'
+                         'estimate by 2)')
 parser.add_argument('-quad', action='store_true', default=False,
-                    help='use quadrilateral finite elements')
+                    help='use quadrilateral finite elements (with -mesh: require\n'
+                         'a quadrilateral mesh)')
+parser.add_argument('-reductiontiming', action='store_true', default=False,
+                    help='report time in global reductions versus compute in KSP')
 parser.add_argument('-refine', type=int, default=0, metavar='R',
                     help='number of refinement levels (e.g. for GMG)')
 parser.add_argument('-schurgmg', metavar='X', default='',
-                    help='Schur+GMG PC solver package: diag|lower|full')
+                    help='Schur+GMG PC solver package: diag|lower|full, or auto to\n'
+                         'choose one from -autotunedb (see -autotune), or pipelined\n'
+                         'variants diag-pipe|lower-pipe|full-pipe, or classical\n'
+                         'Gram-Schmidt variants diag-cgs|lower-cgs|full-cgs')
 parser.add_argument('-schurpre', metavar='X', default='selfp',
                     help='how Schur block is preconditioned: selfp|mass')
+parser.add_argument('-sellreport', action='store_true', default=False,
+                    help='compare AIJ and SELL MatMult throughput for the velocity\n'
+                         'block on each level')
 parser.add_argument('-showinfo', action='store_true', default=False,
                     help='print function space sizes and solution norms')
 parser.add_argument('-stokeshelp', action='store_true', default=False,
                     help='help for stokes.py options')
+parser.add_argument('-telescope', type=int, default=0, metavar='R',
+                    help='gather GMG coarse level of velocity onto 1/R of the\n'
+                         'processes (with -schurgmg)')
+parser.add_argument('-transfer', metavar='X', type=str, default='',
+                    help='GMG transfers of velocity (with -schurgmg) by matfree\n'
+                         'kernels, or by SpMV with assembled matrices:\n'
+                         'matfree|assembled; reports time per level')
 parser.add_argument('-udegree', type=int, default=2, metavar='K',
                     help='polynomial degree for velocity (default=2)')
 parser.add_argument('-vectorlap', action='store_true', default=False,
                     help='use vector laplacian residual formula')
+parser.add_argument('-vectorize', metavar='X', type=str, default='none',
+                    help='vectorize residual and Jacobian assembly across cells:\n'
+                         'none|avx2|avx512 (4 or 8 cells per kernel call)')
 args, unknown = parser.parse_known_args()
 assert not (args.analytical and args.nobase), 'conflict in problem choice options'
 
@@ -63,18 +154,111 @@ assert not (args.analytical and args.nobase), 'conflict in problem choice option
 if args.stokeshelp:
     parser.print_help()
 
+# optionally vectorize assembly kernels across cells; before any is built
+vectorize(args.vectorize)
+
+def pointdofs(depth, quad):
+    '''Number of mixed-space DOFs at a mesh point of given depth.'''
+    def cg(k):
+        return [1, k-1, (k-1)**2 if quad else (k-1)*(k-2)//2][depth] if k > 0 else 0
+    def dg(k):
+        return [0, 0, (k+1)**2 if quad else (k+1)*(k+2)//2][depth]
+    return 2 * cg(args.udegree) + (dg(args.pdegree) if args.dp else cg(args.pdegree))
+
+# weight, relative to one DOF of element assembly, of one owned DOF in the
+# solve:  assembly touches each closure DOF of a cell once, while the solve
+# touches each owned row once per MatMult and smoother sweep, a few times per
+# Krylov iteration; this is a rough ratio, not a calibrated one
+SOLVEWEIGHT = 6.0
+
+def weightcells(plex):
+    '''Set a local section on the (undistributed) plex whose number of DOFs
+    on each cell is its partitioning weight:  SOLVEWEIGHT times its share of
+    the mixed-space DOFs, each DOF being split among the cells which contain
+    it, plus the assembly cost, proportional to the DOFs in its closure.
+    DMPlexDistribute uses such a section for cell (graph vertex) weights.'''
+    pStart, pEnd = plex.getChart()
+    cStart, cEnd = plex.getHeightStratum(0)
+    quad = (cEnd > cStart and plex.getConeSize(cStart) == 4)
+    dofs = np.zeros(pEnd - pStart)
+    for depth in range(3):
+        start, end = plex.getDepthStratum(depth)
+        dofs[start-pStart:end-pStart] = pointdofs(depth, quad)
+    closures = [plex.getTransitiveClosure(c)[0] - pStart for c in range(cStart, cEnd)]
+    ncells = np.zeros(pEnd - pStart)
+    for cl in closures:
+        ncells[cl] += 1
+    weights = PETSc.Section().create(comm=plex.comm)
+    weights.setChart(pStart, pEnd)
+    for c, cl in zip(range(cStart, cEnd), closures):
+        share = np.sum(dofs[cl] / ncells[cl])
+        weights.setDof(c, max(1, int(round(SOLVEWEIGHT * share + np.sum(dofs[cl])))))
+    weights.setUp()
+    plex.setLocalSection(weights)
+    return plex
+
+def boxplex(nx, ny, quad):
+    '''DMPlex for the unit square with nx x ny cells, with the same cells
+    (for triangles, the same "left" diagonals), vertex coordinates, and
+    boundary i.d.s as UnitSquareMesh, as below, so that weighting changes
+    only the partition.  Compare RectangleMesh in Firedrake.'''
+    from firedrake.mesh import plex_from_cell_list
+    xcoords, ycoords = np.linspace(0.0, 1.0, nx + 1), np.linspace(0.0, 1.0, ny + 1)
+    coords = np.asarray(np.meshgrid(xcoords, ycoords)).swapaxes(0, 2).reshape(-1, 2)
+    i, j = np.meshgrid(np.arange(nx, dtype=np.int32), np.arange(ny, dtype=np.int32))
+    cells = [i*(ny+1) + j, i*(ny+1) + j+1, (i+1)*(ny+1) + j+1, (i+1)*(ny+1) + j]
+    cells = np.asarray(cells).swapaxes(0, 2).reshape(-1, 4)
+    if not quad:
+        cells = cells[:, [0, 1, 3, 1, 2, 3]].reshape(-1, 3)
+    plex = plex_from_cell_list(2, cells, coords, COMM_WORLD)
+    if plex.hasLabel('Face Sets'):
+        plex.removeLabel('Face Sets')
+    plex.createLabel('Face Sets')
+    xy = plex.getCoordinatesLocal().array.reshape((-1, 2))
+    vStart, _ = plex.getDepthStratum(0)
+    fStart, fEnd = plex.getHeightStratum(1)
+    for f in range(fStart, fEnd):
+        if plex.getSupportSize(f) == 1:
+            xm, ym = xy[plex.getCone(f) - vStart].mean(axis=0)
+            bid = 1 if xm < 1.0e-12 else 2 if xm > 1.0 - 1.0e-12 \
+                  else 3 if ym < 1.0e-12 else 4
+            plex.setLabelValue('Face Sets', f, bid)
+    return plex
+
 # read Gmsh mesh or create uniform mesh
+if args.partition_weighted and args.partitioner not in ['', 'parmetis']:
+    print('ERROR: -partition_weighted requires the parmetis partitioner (the only one using weights)')
+    sys.exit(1)
+if args.partition_weighted and len(args.partitioner) == 0:
+    distribution = distributionparameters('parmetis')  # uses weights
+else:
+    distribution = distributionparameters(args.partitioner)
 if len(args.mesh) > 0:
     assert (not args.analytical), 'Gmsh file not allowed for -analytical problem'
     assert (not args.nobase), 'Gmsh file not allowed for -nobase problem'
     PETSc.Sys.Print('reading mesh from %s ...' % args.mesh)
-    mesh = Mesh(args.mesh)
+    if args.partition_weighted:
+        plex = weightcells(PETSc.DMPlex().createFromFile(args.mesh, comm=COMM_WORLD))
+        mesh = Mesh(plex, distribution_parameters=distribution)
+    else:
+        mesh = Mesh(args.mesh, distribution_parameters=distribution)
+    # Gmsh meshes from lidbox.py -quad or angle.py -quad are all-quadrilateral
+    isquad = (mesh.ufl_cell().cellname() == 'quadrilateral')
+    if args.quad and not isquad:
+        print('ERROR: -quad requires an all-quadrilateral mesh; see lidbox.py -quad')
+        sys.exit(1)
+    args.quad = isquad
     meshstr = ' on mesh'
     other = (41,)
     lid = (40,)
 else:
     mx, my = args.mx, args.my
-    mesh = UnitSquareMesh(mx-1, my-1, quadrilateral=args.quad)
+    if args.partition_weighted:
+        plex = weightcells(boxplex(mx-1, my-1, args.quad))
+        mesh = Mesh(plex, distribution_parameters=distribution)
+    else:
+        mesh = UnitSquareMesh(mx-1, my-1, quadrilateral=args.quad,
+                              distribution_parameters=distribution)
     mx, my = (mx-1) * 2**args.refine + 1, (my-1) * 2**args.refine + 1
     meshstr = ' on %d x %d grid' % (mx,my)
     # boundary i.d.s:    ---4---
@@ -88,61 +272,131 @@ else:
         other = (1,2,3)
     lid = (4,)
 
+def stretch(t, R):
+    '''Geometric stretching map of [0,1] onto itself; cells near t=0 are R
+    times smaller than cells near t=1.'''
+    return (R**t - 1.0) / (R - 1.0)
+
+def grade(mesh, R):
+    '''Apply a separable, analytical grading toward the lower corners (0,0)
+    and (1,0) to the coordinates of a mesh of the unit square.  Symmetric
+    stretching in x refines toward both x=0 and x=1, while one-sided
+    stretching in y refines toward y=0.  Applied to every level of a
+    hierarchy of axis-parallel quadrilaterals, each coarse cell maps to a
+    rectangle which the images of its children tile exactly, so the graded
+    hierarchy stays nested.  This fails for triangles:  the midpoint of a
+    diagonal edge does not map onto the image of that edge, because the
+    stretch differs in x and y.  Compare the Gmsh characteristic lengths in
+    lidbox.py.'''
+    xy = mesh.coordinates.dat.data
+    s, t = xy[:,0].copy(), xy[:,1].copy()
+    left = (s <= 0.5)
+    xy[left,0] = 0.5 * stretch(2.0 * s[left], R)
+    xy[~left,0] = 1.0 - 0.5 * stretch(2.0 - 2.0 * s[~left], R)
+    xy[:,1] = stretch(t, R)
+
+# optionally predict resources of the fine problem from the coarse mesh only
+if args.dryrun:
+    R = args.refine
+    quad = (mesh.ufl_cell().cellname() == 'quadrilateral')
+    def spaces(m):
+        Vm = VectorFunctionSpace(m, 'CG', degree=args.udegree)
+        Wm = FunctionSpace(m, 'DG' if args.dp else 'CG', degree=args.pdegree)
+        return Vm, Wm
+    def Ablock(m):
+        Vm, _ = spaces(m)
+        return inner(grad(TrialFunction(Vm)), grad(TestFunction(Vm))) * dx
+    def Bblock(m):
+        Vm, Wm = spaces(m)
+        return div(TrialFunction(Vm)) * TestFunction(Wm) * dx
+    nnzA, nnzB = countnonzeros(mesh, R, Ablock), countnonzeros(mesh, R, Bblock)
+    nu = [2 * countdofs(entitycounts(mesh, l, quad), args.udegree, quad) for l in range(R+1)]
+    n_p = countdofs(entitycounts(mesh, R, quad), args.pdegree, quad, args.dp)
+    dryrunreport([('n_u', nu[-1]), ('n_p', n_p)],
+                 [('A (u-u)', nnzA(nu[-1])), ('B (p-u)', nnzB(n_p)), ('B^T (u-p)', nnzB(n_p))],
+                 [(n, nnzA(n)) for n in nu[:-1]], 35,
+                 args.dryrunnp if args.dryrunnp > 0 else mesh.comm.size,
+                 args.calibrate)
+    sys.exit(0)
+
 # enable GMG using hierarchy
 if args.refine > 0:
     hierarchy = MeshHierarchy(mesh, args.refine)
     mesh = hierarchy[-1]     # the fine mesh
     if len(args.mesh) > 0:
         meshstr += ' (%d levels refinement)' % args.refine
+if args.grade > 0.0:
+    assert (len(args.mesh) == 0), '-grade only applies to uniform grid'
+    assert (args.grade > 1.0), '-grade R requires R > 1'
+    assert args.quad, '-grade requires -quad (graded triangle hierarchies are not nested)'
+    # grade every level so GMG sees nested, structured, graded meshes
+    for m in (hierarchy if args.refine > 0 else [mesh,]):
+        grade(m, args.grade)
+    meshstr += ' (graded %g times toward lower corners)' % args.grade
 x,y = SpatialCoordinate(mesh)
 mesh.topology_dm.viewFromOptions('-dm_view')
 
-# define mixed finite elements; for family names see
-#   https://www.firedrakeproject.org/variational-problems.html#supported-finite-elements
-V = VectorFunctionSpace(mesh, 'CG', degree=args.udegree)  # CG = Lagrange
-if args.dp:
-    W = FunctionSpace(mesh, 'DG', degree=args.pdegree)  # DG = Discontinuous Lagrange
-else:
-    W = FunctionSpace(mesh, 'CG', degree=args.pdegree)
-Z = V * W
+def stokesproblem(mesh):
+    '''Build the mixed space, boundary conditions, nullspace, unknown, and
+    weak form on mesh.  Called on the fine mesh, and on a coarse level by
+    -autotune.'''
+    x,y = SpatialCoordinate(mesh)
+    # define mixed finite elements; for family names see
+    #   https://www.firedrakeproject.org/variational-problems.html#supported-finite-elements
+    V = VectorFunctionSpace(mesh, 'CG', degree=args.udegree)  # CG = Lagrange
+    if args.dp:
+        W = FunctionSpace(mesh, 'DG', degree=args.pdegree)  # DG = Discontinuous Lagrange
+    else:
+        W = FunctionSpace(mesh, 'CG', degree=args.pdegree)
+    Z = V * W
 
-# define body force and Dir. boundary condition (on velocity only)
-#     note: UFL as_vector() takes UFL expressions and combines
-if args.analytical:
-    assert (len(args.mesh) == 0)  # require UnitSquareMesh
-    assert (args.mu == 1.0)
-    f_body = as_vector([ 28.0 * pi*pi * sin(4.0*pi*x) * cos(4.0*pi*y), \
-                       -36.0 * pi*pi * cos(4.0*pi*x) * sin(4.0*pi*y)])
-    u_12 = Function(V).interpolate(as_vector([0.0,-sin(4.0*pi*y)]))
-    u_34 = Function(V).interpolate(as_vector([sin(4.0*pi*x),0.0]))
-    bcs = [ DirichletBC(Z.sub(0), u_12, (1,2)),
-            DirichletBC(Z.sub(0), u_34, (3,4)) ]
-else:
-    f_body = Constant((0.0, 0.0))  # no body force in lid-driven cavity
-    u_noslip = Constant((0.0, 0.0))
-    ux_lid = args.lidscale * x * (1.0 - x)
-    u_lid = Function(V).interpolate(as_vector([ux_lid,0.0]))
-    bcs = [ DirichletBC(Z.sub(0), u_noslip, other),
-            DirichletBC(Z.sub(0), u_lid,    lid)   ]
-
-# if Dirichlet-only b.c.s on velocity then set nullspace to constant pressure
-if args.nobase:
-    ns = None
-else:
-    ns = MixedVectorSpaceBasis(Z, [Z.sub(0), VectorSpaceBasis(constant=True)])
-
-# define weak form
-up = Function(Z)
-u,p = split(up)
-v,q = TestFunctions(Z)
-if args.vectorlap:   # form which is special to constant viscosity
-    F = (args.mu * inner(grad(u), grad(v)) - p * div(v) - div(u) * q \
-         - inner(f_body,v)) * dx
-else:                # form that generalizes to variable or nonlinear viscosity
-    Du = 0.5 * (grad(u)+grad(u).T)
-    Dv = 0.5 * (grad(v)+grad(v).T)
-    F = (2.0 * args.mu * inner(Du,Dv) - p * div(v) - div(u) * q \
-         - inner(f_body,v)) * dx
+    # define body force and Dir. boundary condition (on velocity only)
+    #     note: UFL as_vector() takes UFL expressions and combines
+    if args.analytical:
+        assert (len(args.mesh) == 0)  # require UnitSquareMesh
+        assert (args.mu == 1.0)
+        f_body = as_vector([ 28.0 * pi*pi * sin(4.0*pi*x) * cos(4.0*pi*y), \
+                           -36.0 * pi*pi * cos(4.0*pi*x) * sin(4.0*pi*y)])
+        u_12 = Function(V).interpolate(as_vector([0.0,-sin(4.0*pi*y)]))
+        u_34 = Function(V).interpolate(as_vector([sin(4.0*pi*x),0.0]))
+        bcs = [ DirichletBC(Z.sub(0), u_12, (1,2)),
+                DirichletBC(Z.sub(0), u_34, (3,4)) ]
+    else:
+        f_body = Constant((0.0, 0.0))  # no body force in lid-driven cavity
+        u_noslip = Constant((0.0, 0.0))
+        ux_lid = args.lidscale * x * (1.0 - x)
+        u_lid = Function(V).interpolate(as_vector([ux_lid,0.0]))
+        bcs = [ DirichletBC(Z.sub(0), u_noslip, other),
+                DirichletBC(Z.sub(0), u_lid,    lid)   ]
+
+    # if Dirichlet-only b.c.s on velocity then set nullspace to constant pressure
+    if args.nobase:
+        ns = None
+    else:
+        ns = MixedVectorSpaceBasis(Z, [Z.sub(0), VectorSpaceBasis(constant=True)])
+
+    # define weak form
+    up = Function(Z)
+    u,p = split(up)
+    v,q = TestFunctions(Z)
+    if args.vectorlap:   # form which is special to constant viscosity
+        F = (args.mu * inner(grad(u), grad(v)) - p * div(v) - div(u) * q \
+             - inner(f_body,v)) * dx
+    else:                # form that generalizes to variable or nonlinear viscosity
+        Du = 0.5 * (grad(u)+grad(u).T)
+        Dv = 0.5 * (grad(v)+grad(v).T)
+        F = (2.0 * args.mu * inner(Du,Dv) - p * div(v) - div(u) * q \
+             - inner(f_body,v)) * dx
+    return V, W, Z, bcs, ns, up, F
+
+V, W, Z, bcs, ns, up, F = stokesproblem(mesh)
+
+# form compiler parameters for residual and Jacobian
+fcp = formparameters(args.qdegree, args.formmode, args.quad)
+
+if args.formreport:
+    J = derivative(F, up)
+    formreport(mesh, [('residual', F), ('jacobian', J), ('action', action(J, up))], fcp)
 
 # some fieldsplit/Schur solver notes:
 # 1. -s_pc_fieldsplit_type schur
@@ -185,6 +439,18 @@ sgmg = {# diagonal Schur; use minres or gmres or fgmres
            {'pc_fieldsplit_schur_fact_type': 'full'},
        }
 
+# communication-avoiding variants of the above, for many processes:
+#   *-pipe   pipelined GMRES overlaps the global reduction of each iteration
+#            with operator and PC application (PETSc has no pipelined MINRES)
+#   *-cgs    GMRES with classical Gram-Schmidt, which is not pipelined but
+#            needs two blocking reductions per iteration (VecMDot, VecNorm)
+#            instead of the k+1 of modified Gram-Schmidt at iteration k
+# note -s_ksp_type on the command line overrides these
+for fact in ['diag', 'lower', 'full']:
+    sgmg[fact + '-pipe'] = dict(sgmg[fact], ksp_type='pgmres')
+    sgmg[fact + '-cgs'] = dict(sgmg[fact], ksp_type='gmres',
+                               ksp_gmres_classicalgramschmidt=True)
+
 class Mass(AuxiliaryOperatorPC):
 
     def form(self, pc, test, trial):
@@ -192,6 +458,132 @@ class Mass(AuxiliaryOperatorPC):
         bcs = None
         return (a, bcs)
 
+class LineSmoother(PCBase):
+    '''Block Jacobi over lines of strong coupling, for GMG levels on strongly
+    graded meshes where point smoothers degrade.  Nodes I,J are strongly
+    coupled if |A_IJ| >= theta max_K |A_IK|, with |A_IJ| summed over the
+    velocity components.  Nodes with at most two strong neighbors are chained
+    into lines, of at most maxlen nodes, and the remaining (isotropic) nodes
+    are their own blocks.  The lines are made contiguous by a permutation so
+    that PETSc's variable-point-block Jacobi (vpbjacobi) inverts them.  Lines
+    do not cross process boundaries.  Options, with the level prefix:
+      -..._line_theta (default 0.25), -..._line_maxlen (default 32).'''
+
+    needs_python_pmat = False
+
+    def initialize(self, pc):
+        opts = PETSc.Options(pc.getOptionsPrefix() + 'line_')
+        self.theta = opts.getReal('theta', 0.25)
+        self.maxlen = opts.getInt('maxlen', 32)
+        self.inner = PETSc.PC().create(comm=pc.comm)
+        self.inner.setType('vpbjacobi')
+        self.update(pc)
+
+    def lines(self, P):
+        from scipy.sparse import coo_matrix
+        bs = P.getBlockSize()
+        rstart, rend = P.getOwnershipRange()
+        nloc = (rend - rstart) // bs
+        ai, aj, av = P.getValuesCSR()
+        rows = np.repeat(np.arange(rend - rstart), np.diff(ai)) // bs
+        cols = aj - rstart
+        keep = (cols >= 0) & (cols < rend - rstart)
+        I, J, a = rows[keep], cols[keep] // bs, abs(av[keep])
+        keep = (I != J)
+        S = coo_matrix((a[keep], (I[keep], J[keep])), shape=(nloc,nloc)).tocsr()
+        S.eliminate_zeros()
+        # strong connections, and nodes which are candidates for lines
+        rowmax = S.max(axis=1).toarray().ravel()
+        Srow = np.repeat(np.arange(nloc), np.diff(S.indptr))
+        strong = S.data >= self.theta * rowmax[Srow]
+        candidate = np.bincount(Srow[strong], minlength=nloc) <= 2
+        link = strong & candidate[Srow] & candidate[S.indices]
+        # neighbors in line graph, which has degree at most two
+        nbrs = [[] for _ in range(nloc)]
+        for i, j in zip(Srow[link], S.indices[link]):
+            nbrs[i].append(j)
+        for i in range(nloc):  # keep only mutual links
+            nbrs[i] = [j for j in nbrs[i] if i in nbrs[j]]
+        # walk each line from an end (cycles are walked from any node),
+        # cutting into pieces of length maxlen
+        order, sizes = [], []
+        visited = np.zeros(nloc, dtype=bool)
+        for ends in (True, False):
+            for i in range(nloc):
+                if visited[i] or (ends and len(nbrs[i]) > 1):
+                    continue
+                prev, cur, n = -1, i, 0
+                while cur >= 0 and not visited[cur]:
+                    visited[cur] = True
+                    order.append(cur)
+                    n += 1
+                    if n == self.maxlen:
+                        sizes.append(n)
+                        n = 0
+                    nxt = [j for j in nbrs[cur] if j != prev and not visited[j]]
+                    prev, cur = cur, (nxt[0] if len(nxt) > 0 else -1)
+                if n > 0:
+                    sizes.append(n)
+        order = np.array(order, dtype=PETSc.IntType)
+        perm = (bs * order[:,None] + np.arange(bs)[None,:]).flatten()
+        return perm.astype(PETSc.IntType), bs * np.array(sizes, dtype=PETSc.IntType)
+
+    def update(self, pc):
+        _, P = pc.getOperators()
+        self.perm, sizes = self.lines(P)
+        rstart = P.getOwnershipRange()[0]
+        isperm = PETSc.IS().createGeneral(rstart + self.perm, comm=P.comm)
+        self.Pperm = P.permute(isperm, isperm)
+        self.Pperm.setVariableBlockSizes(sizes)
+        self.inner.setOperators(self.Pperm, self.Pperm)
+        self.inner.setUp()
+        self.xp, self.yp = self.Pperm.createVecs()
+        self.nlines = np.count_nonzero(sizes > P.getBlockSize())
+
+    def apply(self, pc, x, y):
+        self.xp.array[:] = x.array_r[self.perm]
+        self.inner.apply(self.xp, self.yp)
+        y.array[self.perm] = self.yp.array_r
+
+    def applyTranspose(self, pc, x, y):
+        self.xp.array[:] = x.array_r[self.perm]
+        self.inner.applyTranspose(self.xp, self.yp)
+        y.array[self.perm] = self.yp.array_r
+
+    def view(self, pc, viewer=None):
+        super().view(pc, viewer)
+        viewer.printfASCII('  block Jacobi over %d lines of strong coupling (theta=%g, maxlen=%d)\n' \
+                           % (self.nlines, self.theta, self.maxlen))
+
+# choice of smoother for GMG on velocity block
+smooth = {# PETSc default smoother: Chebyshev + SOR
+          'point':
+             {},
+          # Chebyshev + block Jacobi over algebraically-detected lines
+          'line':
+             {'fieldsplit_0_mg_levels_ksp_type': 'chebyshev',
+              'fieldsplit_0_mg_levels_pc_type': 'python',
+              'fieldsplit_0_mg_levels_pc_python_type': '__main__.LineSmoother'},
+          # Chebyshev + additive Schwarz over vertex-star patches, which
+          # contain all cells (anisotropic or not) touching each vertex; the
+          # (basic, not restricted) ASM is symmetric and Chebyshev is a fixed
+          # polynomial, so the V-cycle stays linear, as the outer minres or
+          # gmres requires
+          'star':
+             {'fieldsplit_0_mg_levels_ksp_type': 'chebyshev',
+              'fieldsplit_0_mg_levels_pc_type': 'python',
+              'fieldsplit_0_mg_levels_pc_python_type': 'firedrake.ASMStarPC',
+              'fieldsplit_0_mg_levels_pc_star_construct_dim': 0,
+              'fieldsplit_0_mg_levels_pc_star_sub_sub_pc_type': 'lu'},
+          # Chebyshev + Jacobi on SELL copies of the level operators, for
+          # vectorized MatMult
+          'sell':
+             {'fieldsplit_0_mg_levels_ksp_type': 'richardson',
+              'fieldsplit_0_mg_levels_ksp_max_it': 1,
+              'fieldsplit_0_mg_levels_pc_type': 'python',
+              'fieldsplit_0_mg_levels_pc_python_type': 'perftools.SELLChebyshev'},
+         }
+
 # choice of preconditioning method for Schur block
 spre = {# precondition Schur using "selfp" and Jacobi application
         'selfp':
@@ -209,20 +601,140 @@ spre = {# precondition Schur using "selfp" and Jacobi application
             'fieldsplit_1_aux_sub_pc_type': 'icc'},
        }
 
+transfer = timedtransfer(args.transfer)
+
 # select solver package
-sparams = {'snes_type': 'ksponly'}  # applies to all
-if len(args.schurgmg) > 0:
-    sparams.update(common)
-    try:
-        sparams.update(sgmg[args.schurgmg])
-    except KeyError:
-        print('ERROR: invalid -schurgmg; choices are %s' % list(sgmg.keys()))
-        sys.exit(1)
+def solverpackage(schurgmg, schurpre):
+    sparams = {'snes_type': 'ksponly'}  # applies to all
+    if args.baij:
+        assert len(schurgmg) > 0, '-baij requires -schurgmg (LU cannot factor MatNest)'
+        # fieldsplit extracts the nest blocks without copies, so the velocity
+        # solver, including the GMG smoothers, works on the BAIJ block
+        sparams.update({'mat_type': 'nest',
+                        'sub_mat_type': 'baij'})
+    if len(schurgmg) > 0:
+        sparams.update(common)
+        try:
+            sparams.update(sgmg[schurgmg])
+        except KeyError:
+            print('ERROR: invalid -schurgmg; choices are %s' % list(sgmg.keys()))
+            sys.exit(1)
+        try:
+            sparams.update(spre[schurpre])
+        except KeyError:
+            print('ERROR: invalid -schurpre; choices are %s' % list(spre.keys()))
+            sys.exit(1)
+        try:
+            sparams.update(smooth[args.gmgsmoother])
+        except KeyError:
+            print('ERROR: invalid -gmgsmoother; choices are %s' % list(smooth.keys()))
+            sys.exit(1)
+        if args.telescope > 0:
+            sparams.update(telescope(args.telescope, mesh.comm, 'fieldsplit_0_'))
+    return sparams
+
+# optionally choose the Schur+GMG package automatically:  consult a local
+# database keyed by (element pair, mesh type, decade of mu) and, if there is
+# no entry, or with -autotune, run short probe solves of all packages on a
+# coarse level of the hierarchy, extrapolate time-to-tolerance, prune the
+# slower half, probe the rest longer, and store the winner for the fine solve
+def autotunekey():
+    fe = '%s_%d x %s%s_%d' % (['P','Q'][args.quad],args.udegree,
+                              'D' if args.dp else '',['P','Q'][args.quad],args.pdegree)
+    meshtype = 'gmsh:' + os.path.basename(args.mesh) if len(args.mesh) > 0 \
+               else 'uniform'
+    return '%s|%s|mu=1e%d' % (fe,meshtype,int(np.floor(np.log10(args.mu))))
+
+def probe(problem, package, its, solver=None):
+    '''Solve problem = (F, up, bcs, ns) with at most its iterations; return
+    (solver, time, residual reduction per iteration).'''
+    import time
+    F, up, bcs, ns = problem
+    schurgmg, schurpre = package
+    if solver is None:
+        params = solverpackage(schurgmg, schurpre)
+        params.update({'ksp_type': 'minres' if schurgmg.startswith('diag') else 'gmres',
+                       'ksp_rtol': 1.0e-50,   # run exactly its iterations
+                       'ksp_max_it': its,
+                       'snes_lag_jacobian': -2,
+                       'snes_lag_preconditioner': -2})
+        solver = NonlinearVariationalSolver(
+                     NonlinearVariationalProblem(F, up, bcs=bcs,
+                                                 form_compiler_parameters=fcp),
+                     nullspace=ns, options_prefix='autotune_', solver_parameters=params)
+    ksp = solver.snes.getKSP()
+    ksp.setTolerances(max_it=its)
+    ksp.setConvergenceHistory()
+    up.assign(0.0)
+    comm = up.function_space().mesh().comm
+    comm.Barrier()
+    t0 = time.perf_counter()
     try:
-        sparams.update(spre[args.schurpre])
-    except KeyError:
-        print('ERROR: invalid -schurpre; choices are %s' % list(spre.keys()))
-        sys.exit(1)
+        solver.solve()
+    except ConvergenceError:
+        pass  # expected: max_it reached
+    t = comm.allreduce(time.perf_counter() - t0, op=MPI.MAX)
+    hist = ksp.getConvergenceHistory()
+    rho = (hist[-1] / hist[0])**(1.0 / max(len(hist) - 1, 1)) if hist[0] > 0 else 0.0
+    return solver, t, min(rho, 0.9999)
+
+def autotune():
+    '''Rank the packages by predicted time on level -autotunelevel, which
+    has the same element pair, mesh type, and mu as the fine level but costs
+    a fraction of a fine solve.'''
+    level = min(args.autotunelevel, args.refine)
+    pmesh = hierarchy[level] if args.refine > 0 else mesh
+    _, _, _, pbcs, pns, pup, pF = stokesproblem(pmesh)
+    problem = (pF, pup, pbcs, pns)
+    rtol = PETSc.Options().getReal('s_ksp_rtol', 1.0e-5)
+    needed = lambda rho: np.log(rtol) / np.log(rho) if rho > 0.0 else 1.0
+    packages = [(g, p) for g in ['diag', 'lower', 'full'] for p in spre.keys()]
+    # untimed warm-up with each Schur preconditioner, so that the JIT
+    # compilation of the residual, Jacobian, and mass-matrix kernels is not
+    # charged to whichever package is probed first
+    for p in spre.keys():
+        probe(problem, ('diag', p), 1)
+    # round 1:  setup plus 2 iterations for all packages
+    k1, k2 = 2, 6
+    results = {}
+    for package in packages:
+        solver, t1, rho = probe(problem, package, k1)
+        results[package] = [solver, t1, rho, t1 + needed(rho) * t1 / k1]
+    survivors = sorted(packages, key=lambda pk: results[pk][3])[:(len(packages)+1)//2]
+    # round 2:  survivors reuse their setup and run k2 iterations, which gives
+    # the setup time S and time per iteration I in  T(k) = S + k I
+    for package in survivors:
+        solver, t1, _, _ = results[package]
+        _, t2, rho = probe(problem, package, k2, solver)
+        I = t2 / k2
+        results[package][2:] = [rho, max(t1 - k1 * I, 0.0) + needed(rho) * I]
+    for package in packages:
+        PETSc.Sys.Print('  autotune: %-5s + %-5s predicted %.3e s to rtol %.0e on level %d%s' \
+                        % (package + (results[package][3],rtol,level,
+                           '' if package in survivors else ' (pruned)')))
+    return min(survivors, key=lambda pk: results[pk][3])
+
+if args.schurgmg == 'auto' or args.autotune:
+    assert args.schurgmg in ['', 'auto'], '-autotune and -schurgmg %s conflict' % args.schurgmg
+    assert args.autotunelevel >= 1, '-autotunelevel L requires L >= 1'
+    db = {}
+    if mesh.comm.rank == 0 and os.path.exists(args.autotunedb):
+        with open(args.autotunedb) as f:
+            db = json.load(f)
+    db = mesh.comm.bcast(db, root=0)
+    key = autotunekey()
+    if args.autotune or key not in db:
+        PETSc.Sys.Print('autotuning Schur+GMG package for %s ...' % key)
+        db[key] = autotune()
+        if mesh.comm.rank == 0:
+            with open(args.autotunedb, 'w') as f:
+                json.dump(db, f, indent=2)
+    args.schurgmg, args.schurpre = db[key]
+    PETSc.Sys.Print('using Schur+GMG package %s + %s from %s' \
+                    % (args.schurgmg,args.schurpre,args.autotunedb))
+sparams = solverpackage(args.schurgmg, args.schurpre)
+if args.schurgmg == 'auto' or args.autotune:
+    sparams['ksp_type'] = 'minres' if args.schurgmg.startswith('diag') else 'gmres'
 
 # describe mixed FE method
 uFEstr = '%s_%d' % (['P','Q'][args.quad],args.udegree)
@@ -238,35 +750,169 @@ PETSc.Sys.Print('solving%s with %s x %s %s elements ...' \
                 % (meshstr,uFEstr,pFEstr,mixedname))
 
 # actually solve
-solve(F == 0, up, bcs=bcs, nullspace=ns, options_prefix='s',
-      solver_parameters=sparams)
+solver = NonlinearVariationalSolver(NonlinearVariationalProblem(F, up, bcs=bcs,
+                                                form_compiler_parameters=fcp),
+                                    nullspace=ns, options_prefix='s',
+                                    solver_parameters=sparams)
+if transfer is not None:
+    solver.set_transfer_manager(transfer)
+if args.reductiontiming:
+    PETSc.Log.begin()
+if args.discstop > 0.0:
+    assert args.refine > 0, '-discstop requires -refine > 0'
+    # L^2 velocity order of a stable pair is limited by the pressure space:
+    # min(k+1, l+2), e.g. 3 for Taylor-Hood P2 x P1 but 2 for CD P2 x P0
+    order = min(args.udegree + 1, args.pdegree + 2)
+    test, est = discstoptest(hierarchy, up, order, args.discstop, sub=0)
+    discstopsolve(solver, up, test, est, args.discstopcompare)
+else:
+    solver.solve()
+if args.reductiontiming:
+    reductiontiming(mesh.comm)
+if transfer is not None:
+    transfer.report(mesh.comm)
 u,p = up.split()
 
+if args.haloreport:
+    haloreport(mesh, F, up)
+
+def baijreport(J, bcs, nrep=20):
+    '''Assemble the velocity-velocity block as AIJ and as BAIJ and report
+    nonzeros, index storage, and MatMult time and bandwidth.  The bytes moved
+    by MatMult are estimated as the values, the column and row indices, and
+    one read of x and one write of y.'''
+    import time
+    isize = np.dtype(PETSc.IntType).itemsize
+    ssize = np.dtype(PETSc.ScalarType).itemsize
+    results = {}
+    for sub in ['aij', 'baij']:
+        A = assemble(J, bcs=bcs, mat_type='nest', sub_mat_type=sub).petscmat.getNestSubMatrix(0, 0)
+        bs = A.getBlockSize() if 'baij' in A.getType() else 1
+        nz, n = A.getInfo()['nz_used'], A.getSize()[0]
+        index = (nz / bs**2 + n / bs + 1) * isize
+        moved = nz * ssize + index + 2 * n * ssize
+        x, y = A.createVecs()
+        x.set(1.0)
+        A.mult(x, y)
+        A.comm.tompi4py().Barrier()
+        t0 = time.perf_counter()
+        for k in range(nrep):
+            A.mult(x, y)
+        t = A.comm.tompi4py().allreduce(time.perf_counter() - t0, op=MPI.MAX) / nrep
+        results[sub] = (index, t)
+        PETSc.Sys.Print('  velocity block %-4s (bs %d): nnz %d, index storage %.3f MB, MatMult %.3e s, %.2f GB/s' \
+                        % (sub,bs,nz,index / 1.0e6,t,moved / t / 1.0e9))
+    PETSc.Sys.Print('  BAIJ versus AIJ: index storage %.1f%% less, MatMult %.2f times faster' \
+                    % (100.0 * (1.0 - results['baij'][0] / results['aij'][0]),
+                       results['aij'][1] / results['baij'][1]))
+
+if args.baijreport:
+    baijreport(derivative(F, up), bcs)
+
+def velocityblock(m):
+    '''The velocity-velocity block of the Stokes operator on mesh m.'''
+    Vm = VectorFunctionSpace(m, 'CG', degree=args.udegree)
+    w, v = TrialFunction(Vm), TestFunction(Vm)
+    if args.vectorlap:
+        return args.mu * inner(grad(w), grad(v)) * dx
+    Dw, Dv = 0.5 * (grad(w)+grad(w).T), 0.5 * (grad(v)+grad(v).T)
+    return 2.0 * args.mu * inner(Dw, Dv) * dx
+
+if args.sellreport:
+    sellreport(hierarchy if args.refine > 0 else [mesh,], velocityblock)
+
+def partitionreport(mesh, Z):
+    '''Per rank:  cells, cut (interior) facets, neighbor ranks, and owned and
+    ghost DOFs of the mixed space.'''
+    dm = mesh.topology_dm
+    pStart, pEnd = dm.getChart()
+    cStart, cEnd = dm.getHeightStratum(0)
+    fStart, fEnd = dm.getHeightStratum(1)
+    _, ilocal, iremote = dm.getPointSF().getGraph()
+    ghost = np.zeros(pEnd - pStart, dtype=bool)
+    if ilocal is None:
+        ilocal = np.arange(len(iremote)) + pStart
+    ghost[np.asarray(ilocal, dtype=int) - pStart] = True
+    nbrs = len(np.unique(iremote[:,0])) if len(iremote) > 0 else 0
+    # facets in a cut are in the non-core part of the mesh
+    candidates = set()
+    for name in ['pyop2_owned', 'pyop2_ghost']:
+        if dm.hasLabel(name) and dm.getStratumSize(name, 1) > 0:
+            candidates.update(dm.getStratumIS(name, 1).getIndices())
+    cut = 0
+    for f in candidates:
+        if fStart <= f < fEnd and dm.getSupportSize(f) == 2:
+            c0, c1 = dm.getSupport(f)
+            cut += (ghost[c0 - pStart] != ghost[c1 - pStart])
+    ncells = cEnd - cStart - np.count_nonzero(ghost[cStart-pStart:cEnd-pStart])
+    owned = sum(V.dof_dset.size * V.dof_dset.cdim for V in Z)
+    ghosts = sum((V.dof_dset.total_size - V.dof_dset.size) * V.dof_dset.cdim for V in Z)
+    rows = mesh.comm.gather((ncells, cut, nbrs, owned, ghosts), root=0)
+    PETSc.Sys.Print('  partition report: rank    cells      cut  nbrs    owned DOFs    ghost DOFs')
+    if mesh.comm.rank == 0:
+        for rank, row in enumerate(rows):
+            PETSc.Sys.Print('  %22d %8d %8d %5d %13d %13d' % ((rank,) + row))
+        owneds = [row[3] for row in rows]
+        PETSc.Sys.Print('  total edge cut %d, owned DOF imbalance max/mean = %.3f' \
+                        % (sum(row[1] for row in rows) // 2,
+                           max(owneds) / max(np.mean(owneds), 1.0)))
+
+if args.partition_report:
+    partitionreport(mesh, Z)
+
+def functionals(mesh, integrands, degree=None):
+    '''Integrate a list of scalar integrands over the mesh in one assembly, so
+    one generated kernel, one mesh pass and one global reduction, by testing
+    their vector against a Real space.  Optionally fix the quadrature degree.'''
+    R = VectorFunctionSpace(mesh, 'R', 0, dim=len(integrands))
+    b = assemble(inner(as_vector(integrands), TestFunction(R)) * dx(degree=degree))
+    return b.dat.data_ro.copy()
+
+# squared L^2 norms needed below, evaluated together
+post, qdegree = {}, None
+
 # numerical error for -analytical case ONLY
 if args.analytical:
     xexact = sin(4.0*pi*x) * cos(4.0*pi*y)
     yexact = -cos(4.0*pi*x) * sin(4.0*pi*y)
     # compare Logg et al 2012, Fig 20.11; degree 10 is not necessary but same
     # degree as computation spaces will yield wrong rates
-    Vhigh = VectorFunctionSpace(mesh, 'CG', degree=args.udegree+2)
-    Whigh = FunctionSpace(mesh, 'CG', degree=args.pdegree+2)
-    u_exact = Function(Vhigh).interpolate(as_vector([xexact,yexact]))
-    p_exact = Function(Whigh).interpolate(pi * cos(4.0*pi*x) * cos(4.0*pi*y))
-    uerr = sqrt(assemble(dot(u - u_exact, u - u_exact) * dx))
-    perr = sqrt(assemble(dot(p - p_exact, p - p_exact) * dx))
+    if args.errorquad:
+        # evaluate the UFL expressions in the error kernel itself, with the
+        # quadrature degree the degree K+2 interpolants would get; nothing is
+        # allocated on the fine mesh
+        u_exact = as_vector([xexact,yexact])
+        p_exact = pi * cos(4.0*pi*x) * cos(4.0*pi*y)
+        qdegree = 2 * (max(args.udegree,args.pdegree) + 2)
+    else:
+        Vhigh = VectorFunctionSpace(mesh, 'CG', degree=args.udegree+2)
+        Whigh = FunctionSpace(mesh, 'CG', degree=args.pdegree+2)
+        u_exact = Function(Vhigh).interpolate(as_vector([xexact,yexact]))
+        p_exact = Function(Whigh).interpolate(pi * cos(4.0*pi*x) * cos(4.0*pi*y))
+    post['uerr'] = dot(u - u_exact, u - u_exact)
+    post['perr'] = dot(p - p_exact, p - p_exact)
+if args.showinfo:
+    post['uL2'] = dot(u, u)
+    post['pL2'] = dot(p, p)
+if len(post) > 0:
+    post = dict(zip(post.keys(),
+                    np.sqrt(functionals(mesh, list(post.values()), degree=qdegree))))
+
+if args.analytical:
     PETSc.Sys.Print('  numerical errors: |u-uexact|_h = %.2e, |p-pexact|_h = %.2e' \
-                    % (uerr, perr))
+                    % (post['uerr'], post['perr']))
 
 # optionally print Schur/GMG package, number of degrees of freedom, and solution norms
 if args.showinfo:
     if len(args.schurgmg) > 0:
-        PETSc.Sys.Print('  Schur+GMG PC package %s + %s' \
-                        % (args.schurgmg,args.schurpre))
+        PETSc.Sys.Print('  Schur+GMG PC package %s + %s%s' \
+                        % (args.schurgmg,args.schurpre,
+                           '' if args.gmgsmoother == 'point' \
+                           else ' (%s smoother)' % args.gmgsmoother))
     n_u,n_p = V.dim(),W.dim()
     PETSc.Sys.Print('  sizes: n_u = %d, n_p = %d, N = %d' % (n_u,n_p,n_u+n_p))
-    uL2 = sqrt(assemble(dot(u, u) * dx))
-    pL2 = sqrt(assemble(dot(p, p) * dx))
-    PETSc.Sys.Print('  solution norms: |u|_h = %.2e, |p|_h = %.2e' % (uL2, pL2))
+    PETSc.Sys.Print('  solution norms: |u|_h = %.2e, |p|_h = %.2e' \
+                    % (post['uL2'], post['pL2']))
 
 # optionally save to .pvd file viewable with Paraview
 if len(args.o) > 0:
@@ -2,10 +2,17 @@
 set -e
 set +x
 
+STOKES=${STOKES:-../stokes.py}
+
 # run as
 #    ./stokesconv.sh &> stokesconv.txt
 
 COMMON="-analytical -s_ksp_rtol 1.0e-8 -s_ksp_converged_reason"
+# the fixed rtol over-solves on coarse levels; to stop at a fraction of the
+# (estimated) discretization error instead, and see the savings, add
+#    -discstop 0.1 -discstopcompare
+# on the finest levels add -errorquad to avoid the degree K+2 and L+2 spaces
+# used only for the error computation (compare peak memory with -memory_view)
 
 # some GMG+Schur solver alternatives use one each of the following:
 #    -s_ksp_type gmres|fgmres|minres
@@ -17,7 +24,7 @@ SOLVE="-s_ksp_type gmres -schurgmg lower -schurpre selfp"
 # level 6 is 129x129, 7 is 257x257, 8 is 513x513, 9 is 1025x1025
 for FE in "" "-quad" "-pdegree 0 -dp" "-udegree 3 -pdegree 2"; do
     for LEV in 2 3 4 5 6 7 8 9; do   # adjust levels as desired
-        cmd="../stokes.py ${COMMON} ${SOLVE} ${FE} -refine ${LEV} -showinfo"
+        cmd="${STOKES} ${COMMON} ${SOLVE} ${FE} -refine ${LEV} -showinfo"
         echo $cmd
         /usr/bin/time -f "real %e" $cmd
     done
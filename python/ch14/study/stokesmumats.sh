@@ -2,6 +2,8 @@
 set -e
 set +x
 
+STOKES=${STOKES:-../stokes.py}
+
 # generate matrix .dat files for script p4pdes-book/figs/stokesmueigs.py
 # which generates a figure in chapter 14 of book showing dependence of
 # eigenvalues on the viscosity mu
@@ -14,6 +16,6 @@ LEV=2   # 9x9 grid
 
 for MU in 0.00001 0.0001 0.001 0.01 0.1 1.0 10.0 100.0; do
     echo "mu = ${MU}:"
-    ../stokes.py -nobase -mu $MU -refine $LEV $SOLVE $CONVERGE \
+    ${STOKES} -nobase -mu $MU -refine $LEV $SOLVE $CONVERGE \
         -s_mat_type aij -s_ksp_view_mat binary:stokes_mu${MU}.dat
 done
@@ -16,6 +16,11 @@ set +x
 
 # compare stokesopt.sh
 
+# an alternative without Gmsh is an analytically-graded uniform grid of
+# quadrilaterals (graded triangles do not give a nested hierarchy), which has
+# a coarse bottom level for GMG; replace "-mesh ../graded.msh" below by e.g.
+# "-mx 5 -my 5 -quad -grade 100" and increase REFINE by 2 or 3
+
 REFINE=5   # REFINE=4 gives N=8x10^5, REFINE=5 gives N=3.2x10^6, REFINE=6 gives N=1.3x10^7
 
 for SGMG in "-s_ksp_type minres -schurgmg diag" \
@@ -9,8 +9,17 @@ set +x
 # FE method is Q^2 x Q^1 Taylor-Hood
 
 MAXLEV=10   # LEV=9 is 1025x1025 uniform grid with N~~10^7, LEV=10 is 2049^2
+# to check beforehand whether a level fits in memory, without building it:
+#   ../stokes.py -quad -refine 10 -dryrun -dryrunnp 1
+# to compare generic and sum-factorized Q^2 x Q^1 kernels (cells/s):
+#   ../stokes.py -quad -refine 7 -formreport -formmode tensor|spectral
+# to compare AIJ and BAIJ (block size 2) velocity blocks, then solve with BAIJ:
+#   ../stokes.py -quad -refine 7 -baijreport
+#   ../stokes.py -quad -refine 7 -baij -s_ksp_type gmres -schurgmg lower -schurpre mass
 
-# compare 6 Schur+GMG solvers
+# compare 6 Schur+GMG solvers; these are the candidates which
+#   ../stokes.py -quad -refine LEV -schurgmg auto
+# probes, and then remembers, on a new machine or problem class
 for SGMG in "-s_ksp_type minres -schurgmg diag" \
             "-s_ksp_type gmres -schurgmg lower" \
             "-s_ksp_type gmres -schurgmg full"; do
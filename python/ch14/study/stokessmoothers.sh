@@ -0,0 +1,35 @@
+#!/bin/bash
+set -e
+set +x
+
+# run as
+#    ./stokessmoothers.sh &> stokessmoothers.txt
+
+# problem is default lid-driven cavity with Dirichlet on whole boundary
+# on refined versions of lidbox.py meshes with increasing corner refinement
+# FE method is P^2 x P^1 Taylor-Hood
+
+# compare point, line, and vertex-star patch smoothers in the GMG for the
+# velocity block; iteration counts should stay flat for line and star as
+# cornerrefine grows
+
+# compare stokesnonuniform.sh
+
+REFINE=3
+SOLVE="-s_ksp_type gmres -schurgmg lower -schurpre selfp"
+
+for CR in 10 100 1000; do
+    ../lidbox.py -quiet -cornerrefine ${CR} cr${CR}.geo
+    gmsh -v 0 -2 cr${CR}.geo
+    for SMOOTH in point line star; do
+        cmd="../stokes.py -mesh cr${CR}.msh -showinfo -s_ksp_converged_reason ${SOLVE} -gmgsmoother ${SMOOTH} -refine ${REFINE} -log_view"
+        echo $cmd
+        rm -f foo.txt
+        $cmd &> foo.txt
+        'grep' "sizes:" foo.txt
+        'grep' "solve converged due to" foo.txt
+        'grep' "Time (sec):" foo.txt | awk '{print $3}'
+    done
+    echo
+done
+rm -f cr*.geo cr*.msh foo.txt
@@ -12,8 +12,15 @@ MPI="mpiexec --map-by core --bind-to hwthread"  # one possible setting
 
 # see text of chapter for evidence this is a reasonable choice
 SOLVE="-s_ksp_type gmres -schurgmg lower -schurpre selfp"
+# at 64+ processes compare pipelined GMRES, which overlaps the reductions:
+#SOLVE="-schurgmg lower-pipe -schurpre selfp -reductiontiming"
 
 COARSE="-mx 9 -my 9" # need at least one point per process on coarse grid
+
+# the coarse grid is distributed over all processes, but its solve need not
+# be:  to gather it onto P/16 processes (PCTELESCOPE), coarsen further by GAMG
+# with process reduction, and finish with a redundant LU, use instead:
+#COARSE="${COARSE} -telescope 16"
 LEV0=5  # 5 is 257x257 grid on each process
 
 LEV=$LEV0
@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+
+from argparse import ArgumentParser, RawTextHelpFormatter
+import itertools, os, shutil, stat, sys, tarfile, tempfile
+
+parser = ArgumentParser(description="""
+Build, or install, a relocatable cache of the Firedrake kernels (TSFC-generated
+and PyOP2-compiled) needed by ch13/fish.py and ch14/stokes.py for a given
+configuration matrix.  Building runs every configuration once on a tiny mesh,
+including a refinement level so that GMG transfer kernels are generated, with
+fresh cache directories, and then packages them.  Installing unpacks the
+package to (node-local) storage, makes it read-only, and prints the
+environment settings which point Firedrake at it.  For example:
+    $ ./kernelcache.py -build -o kernels.tar.gz -fishdegrees 1,2,3
+    $ ./kernelcache.py -install kernels.tar.gz -dir /tmp/$USER-kernels
+The cache is only valid on machines with the same Firedrake installation and
+compiler.  Kernels do not depend on the mesh size or process count.""",
+    formatter_class=RawTextHelpFormatter,allow_abbrev=False)
+parser.add_argument('-build', action='store_true', default=False,
+                    help='compile the kernels and write the package')
+parser.add_argument('-cells', metavar='X', type=str, default='tri,quad',
+                    help='cell types: tri,quad (default)')
+parser.add_argument('-dir', metavar='DIR', type=str, default='',
+                    help='(with -install) directory to unpack into')
+parser.add_argument('-fishdegrees', metavar='K,..', type=str, default='1,2,3',
+                    help='degrees -k for fish.py (default=1,2,3)')
+parser.add_argument('-install', metavar='PACKAGE', type=str, default='',
+                    help='unpack PACKAGE read-only and print environment settings')
+parser.add_argument('-o', metavar='PACKAGE', type=str, default='kernels.tar.gz',
+                    help='(with -build) output package (default=kernels.tar.gz)')
+parser.add_argument('-schurpre', metavar='X', type=str, default='selfp,mass',
+                    help='stokes.py -schurpre values (default=selfp,mass)')
+parser.add_argument('-stokespairs', metavar='K:L,..', type=str, default='2:1,3:2,2:0d',
+                    help='stokes.py -udegree K -pdegree L pairs; a trailing d means\n'
+                         '-dp (default=2:1,3:2,2:0d)')
+args = parser.parse_args()
+
+# cache locations used by TSFC (via Firedrake) and PyOP2
+ENVS = {'tsfc': 'FIREDRAKE_TSFC_KERNEL_CACHE_DIR',
+        'pyop2': 'PYOP2_CACHE_DIR'}
+
+def configurations():
+    here = os.path.dirname(os.path.abspath(__file__))
+    fish = os.path.join(here, 'ch13', 'fish.py')
+    stokes = os.path.join(here, 'ch14', 'stokes.py')
+    cells = {'tri': '', 'quad': '-quad'}
+    cells = [cells[c] for c in args.cells.split(',')]
+    for k, cell in itertools.product(args.fishdegrees.split(','), cells):
+        yield '%s -refine 1 -k %s %s -s_pc_type mg' % (fish,k,cell)
+    for pair, cell, vectorlap, pre, problem in itertools.product(
+            args.stokespairs.split(','), cells, ['', '-vectorlap'],
+            args.schurpre.split(','), ['', '-analytical', '-nobase']):
+        dp = '-dp' if pair.endswith('d') else ''
+        K, L = pair.rstrip('d').split(':')
+        yield '%s -refine 1 -udegree %s -pdegree %s %s %s %s %s -schurgmg lower -schurpre %s -showinfo' \
+              % (stokes,K,L,dp,cell,vectorlap,problem,pre)
+
+if args.build:
+    staging = tempfile.mkdtemp(prefix='kernelcache-')
+    for name, env in ENVS.items():
+        os.environ[env] = os.path.join(staging, name)  # before Firedrake import
+    import firedrake
+    from runscript import runscript
+    cases = list(configurations())
+    for i, case in enumerate(cases):
+        print('[%d/%d] %s' % (i+1,len(cases),os.path.basename(case.split()[0]) \
+                              + ' ' + ' '.join(case.split()[1:])))
+        sys.stdout.flush()
+        with open(os.devnull, 'w') as devnull:
+            if runscript(case.split(), out=devnull) > 0:
+                print('    case failed; its kernels may be missing')
+    with tarfile.open(args.o, 'w:gz') as tar:
+        for name in ENVS.keys():
+            tar.add(os.path.join(staging, name), arcname=name)
+    shutil.rmtree(staging)
+    print('wrote kernel cache for %d configurations to %s' % (len(cases),args.o))
+elif len(args.install) > 0:
+    assert len(args.dir) > 0, '-install requires -dir'
+    os.makedirs(args.dir, exist_ok=True)
+    # accept only regular files and directories inside -dir, so that a hostile
+    # package cannot write elsewhere (absolute or ../ names, links, devices)
+    top = os.path.realpath(args.dir)
+    with tarfile.open(args.install, 'r:gz') as tar:
+        members = tar.getmembers()
+        for m in members:
+            target = os.path.realpath(os.path.join(top, m.name))
+            if not (m.isfile() or m.isdir()) or os.path.commonpath([top, target]) != top:
+                print('ERROR: %s contains unsafe member %s' % (args.install,m.name))
+                sys.exit(1)
+        tar.extractall(args.dir, members=members)
+    for root, dirs, files in os.walk(args.dir):
+        for f in files:
+            p = os.path.join(root, f)
+            os.chmod(p, os.stat(p).st_mode & ~(stat.S_IWUSR|stat.S_IWGRP|stat.S_IWOTH))
+    for name, env in ENVS.items():
+        print('export %s=%s' % (env,os.path.join(os.path.abspath(args.dir), name)))
+else:
+    parser.print_help()
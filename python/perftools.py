@@ -0,0 +1,496 @@
+'''Performance tools shared by ch13/fish.py and ch14/stokes.py:  option
+handling common to both (vectorization, mesh partitioner, form compiler
+parameters, coarse grid agglomeration), dry-run predictions, form and halo reports, the SELL
+Chebyshev smoother, timed GMG transfers, reduction timing, and
+discretization-aware stopping.  The scripts put this directory on sys.path
+and import from here; Python preconditioners are then named e.g.
+'perftools.SELLChebyshev'.'''
+
+import sys
+from firedrake import *
+from firedrake.petsc import PETSc
+from mpi4py import MPI
+import numpy as np
+
+# cross-element vectorization of assembly kernels
+simd = {'none':   None,
+        'avx2':   4,     # doubles per 256-bit register
+        'avx512': 8}     # doubles per 512-bit register
+
+def vectorize(choice):
+    '''Set the PyOP2 configuration for -vectorize:  batch SIMD-width cells per
+    kernel invocation (Sun et al 2020), or, with none, do not.  The strategy
+    is set for every choice, as in solverserver.py the configuration of one
+    case would otherwise carry over to the next.  Call before any kernel is
+    built.'''
+    from pyop2.configuration import configuration
+    if choice not in simd:
+        print('ERROR: invalid -vectorize; choices are %s' % list(simd.keys()))
+        sys.exit(1)
+    if 'vectorization_strategy' not in configuration:
+        if simd[choice] is None:
+            return
+        print('ERROR: -vectorize needs a PyOP2 with cross-element vectorization')
+        sys.exit(1)
+    if simd[choice] is None:
+        configuration['vectorization_strategy'] = ''
+    else:
+        configuration['vectorization_strategy'] = 'cross-element'
+        configuration['simd_width'] = simd[choice]
+
+# mesh distribution
+def distributionparameters(partitioner):
+    '''Mesh distribution parameters for -partitioner X, or None (Firedrake's
+    default) if X is empty.'''
+    return {'partitioner_type': partitioner} if len(partitioner) > 0 else None
+
+# GMG coarse-level agglomeration
+def telescope(R, comm, prefix=''):
+    '''Solver options for the coarse level of the GMG with options prefix
+    prefix:  PCTELESCOPE moves the coarse problem onto 1/R of the processes of
+    comm, where GAMG coarsens further with its own process reduction and ends
+    with a redundant direct solve.'''
+    c = prefix + 'mg_coarse_'
+    return {c + 'ksp_type': 'preonly',
+            c + 'pc_type': 'telescope',
+            c + 'pc_telescope_reduction_factor': min(R, comm.size),
+            c + 'telescope_ksp_type': 'preonly',
+            c + 'telescope_pc_type': 'gamg',
+            c + 'telescope_pc_gamg_process_eq_limit': 1000,
+            c + 'telescope_pc_gamg_repartition': True,
+            c + 'telescope_mg_coarse_pc_type': 'redundant',
+            c + 'telescope_mg_coarse_redundant_pc_type': 'lu'}
+
+# dry run:  predict sizes, nonzeros, memory, and time from the coarse mesh
+def entitycounts(mesh, refine, quad):
+    '''Global vertex, edge, and cell counts after refine uniform refinements
+    of a simply-connected coarse mesh; edges come from Euler's formula.'''
+    nv = FunctionSpace(mesh, 'CG', 1).dim()
+    nc = FunctionSpace(mesh, 'DG', 0).dim()
+    ne = nv + nc - 1
+    for r in range(refine):
+        if quad:
+            nv, ne, nc = nv + ne + nc, 2*ne + 4*nc, 4*nc
+        else:
+            nv, ne, nc = nv + ne, 2*ne + 3*nc, 4*nc
+    return nv, ne, nc
+
+def countdofs(counts, k, quad, discontinuous=False):
+    '''Number of scalar Lagrange P_k or Q_k DOFs, from entity counts.'''
+    nv, ne, nc = counts
+    if discontinuous:
+        return ((k+1)**2 if quad else (k+1)*(k+2)//2) * nc
+    return nv + (k-1)*ne + ((k-1)**2 if quad else (k-1)*(k-2)//2) * nc
+
+def countnonzeros(mesh, refine, form):
+    '''Predict global nonzeros, as a function of the number of rows, of the
+    matrix of form(m) on the refine-times refined mesh.  Matrices are only
+    assembled on the coarse mesh refined at most twice; beyond that the counts
+    are fitted by  nnz = alpha N + beta sqrt(N),  interior plus boundary.'''
+    levels = [refine,] if refine <= 2 else [1, 2]
+    meshes = MeshHierarchy(mesh, max(levels)) if max(levels) > 0 else [mesh,]
+    data = []
+    for l in levels:
+        A = assemble(form(meshes[l]), mat_type='aij').petscmat
+        data.append((A.getSize()[0], A.getInfo(PETSc.Mat.InfoType.GLOBAL_SUM)['nz_used']))
+    if len(data) == 1:
+        return lambda N: data[0][1]
+    (n1, z1), (n2, z2) = data
+    beta = (z2 / n2 - z1 / n1) / (1.0 / np.sqrt(n2) - 1.0 / np.sqrt(n1))
+    alpha = z1 / n1 - beta / np.sqrt(n1)
+    return lambda N: alpha * N + beta * np.sqrt(N)
+
+def dryrunreport(sizes, blocks, levels, nvecs, P, calibrate):
+    '''Print predicted sizes, nonzeros, memory, and time per rank.  Here
+    blocks is a list of (name, nonzeros) for the fine matrix, and levels a
+    list of (rows, nonzeros) for the coarser GMG level matrices.  AIJ costs
+    12 bytes per nonzero and 4 per row, vectors 8 bytes per entry.  The
+    string calibrate is 'TA,TS':  seconds per assembled nonzero and per
+    solved DOF.'''
+    N = sum(n for _, n in sizes)
+    nnz = sum(z for _, z in blocks)
+    PETSc.Sys.Print('dry run predictions for %d processes:' % P)
+    PETSc.Sys.Print('  sizes: ' + ', '.join('%s = %d' % s for s in sizes) \
+                    + (', N = %d' % N if len(sizes) > 1 else ''))
+    for name, z in blocks:
+        PETSc.Sys.Print('  nonzeros in %s block: %.3e (%.1f per row of N)' % (name,z,z/N))
+    memfine = 12.0 * nnz + 4.0 * N + 8.0 * nvecs * N
+    memlevels = sum(12.0 * z + 4.0 * n + 8.0 * 3 * n for n, z in levels)
+    PETSc.Sys.Print('  memory per rank: %.3e bytes fine level, %.3e bytes coarser GMG levels' \
+                    % (memfine/P,memlevels/P))
+    tasm, tsolve = [float(c) for c in calibrate.split(',')]
+    PETSc.Sys.Print('  time per rank: assembly ~ %.3e s, solve ~ %.3e s (calibration %s)' \
+                    % (tasm * nnz / P,tsolve * N / P,calibrate))
+
+# form compiler parameters, and quadrature degree and assembly throughput of
+# forms
+def formparameters(qdegree, formmode, quad):
+    '''Form compiler parameters for residual and Jacobian from -qdegree and
+    -formmode (stops with an error for an invalid mode).'''
+    fcp = {}
+    if qdegree >= 0:
+        fcp['quadrature_degree'] = qdegree
+    if len(formmode) > 0:
+        if formmode not in ['vanilla', 'tensor', 'spectral']:
+            print('ERROR: invalid -formmode; choices are %s' % ['vanilla', 'tensor', 'spectral'])
+            sys.exit(1)
+        if formmode == 'tensor' and quad:
+            print('ERROR: -formmode tensor does not support -quad (Q_k) elements')
+            sys.exit(1)
+        fcp['mode'] = formmode
+    return fcp
+
+def formreport(mesh, forms, fcp, nrep=3):
+    '''For each (name, form) report the quadrature degree estimated by UFL,
+    the degree actually used, the points per cell, and the assembly time
+    (best of nrep, after a first assembly which includes code generation) and
+    throughput in cells per second.'''
+    import time
+    from ufl.algorithms import estimate_total_polynomial_degree
+    from tsfc.finatinterface import as_fiat_cell
+    from finat.quadrature import make_quadrature
+    cell = as_fiat_cell(mesh.ufl_cell())
+    ncells = mesh.comm.allreduce(mesh.cell_set.size, op=MPI.SUM)
+    for name, form in forms:
+        estimated = max(estimate_total_polynomial_degree(itg.integrand())
+                        for itg in form.integrals())
+        degree = fcp.get('quadrature_degree', estimated)
+        npts = len(make_quadrature(cell, degree).point_set.points)
+        assemble(form, form_compiler_parameters=fcp)
+        times = []
+        for k in range(nrep):
+            mesh.comm.Barrier()
+            t0 = time.perf_counter()
+            assemble(form, form_compiler_parameters=fcp)
+            times.append(mesh.comm.allreduce(time.perf_counter() - t0, op=MPI.MAX))
+        PETSc.Sys.Print('  form %-8s: estimated degree %2d, using %2d (%3d points/cell), mode %s, assembly %.3e s (%.3e cells/s)' \
+                        % (name,estimated,degree,npts,fcp.get('mode', 'default'),min(times),
+                           ncells / min(times)))
+
+# Chebyshev GMG smoother on a SELL copy of the level operator
+class SELLChebyshev(PCBase):
+    '''Smoother on a sliced-ELLPACK (SELL) copy of the operator, whose MatMult
+    is vectorized (AVX2/AVX-512) by PETSc.  The copy is made at each setup.
+    Applies an inner KSP, by default 2 iterations of Chebyshev with Jacobi,
+    which needs only MatMult and the diagonal, to the residual equation with
+    zero initial guess.  Use it under Richardson with one iteration, so that
+    the level KSP keeps its own operator and nonzero initial guesses.
+    Options for the inner KSP have prefix ..._sell_.'''
+
+    needs_python_pmat = False
+
+    def initialize(self, pc):
+        self.ksp = PETSc.KSP().create(comm=pc.comm)
+        self.ksp.setOptionsPrefix(pc.getOptionsPrefix() + 'sell_')
+        self.ksp.setType('chebyshev')
+        self.ksp.getPC().setType('jacobi')
+        self.ksp.setTolerances(max_it=2)
+        self.ksp.setNormType(PETSc.KSP.NormType.NONE)
+        self.ksp.setConvergenceTest(lambda ksp, its, rnorm: 0)  # always max_it
+        opts = PETSc.Options(self.ksp.getOptionsPrefix())
+        if not opts.hasName('ksp_chebyshev_esteig'):  # as PCMG sets for levels
+            opts['ksp_chebyshev_esteig'] = '0,0.1,0,1.1'
+        self.ksp.setFromOptions()
+        self.update(pc)
+
+    def update(self, pc):
+        _, P = pc.getOperators()
+        self.S = P.convert('sell')
+        self.ksp.setOperators(self.S, self.S)
+        self.ksp.setUp()
+
+    def apply(self, pc, x, y):
+        self.ksp.solve(x, y)
+
+    def applyTranspose(self, pc, x, y):
+        self.ksp.solveTranspose(x, y)
+
+    def view(self, pc, viewer=None):
+        super().view(pc, viewer)
+        viewer.printfASCII('  smoother on %s copy of operator:\n' % self.S.getType())
+        self.ksp.view(viewer)
+
+def sellreport(levels, bilinear, nrep=20):
+    '''For the operator bilinear(mesh) on each level compare MatMult on AIJ
+    and on a SELL copy, reporting DOF/s and GB/s.  The bytes moved are
+    estimated as the stored values (for SELL including slice padding), their
+    column indices, and one read of x and one write of y.'''
+    import time
+    isize = np.dtype(PETSc.IntType).itemsize
+    ssize = np.dtype(PETSc.ScalarType).itemsize
+    PETSc.Sys.Print('  level        N   format  nnz stored   MatMult (s)      DOF/s     GB/s')
+    for l, m in enumerate(levels):
+        A = assemble(bilinear(m), mat_type='aij').petscmat
+        n = A.getSize()[0]
+        for M in [A, A.convert('sell')]:
+            stored = M.getInfo()['nz_allocated']
+            moved = stored * (ssize + isize) + 2 * n * ssize
+            x, y = M.createVecs()
+            x.set(1.0)
+            M.mult(x, y)
+            m.comm.Barrier()
+            t0 = time.perf_counter()
+            for k in range(nrep):
+                M.mult(x, y)
+            t = m.comm.allreduce(time.perf_counter() - t0, op=MPI.MAX) / nrep
+            PETSc.Sys.Print('  %5d %8d %8s %11d %13.3e %10.3e %8.2f' \
+                            % (l,n,M.getType(),stored,t,n / t,moved / t / 1.0e9))
+
+# GMG transfers, matrix-free or assembled, timed per level
+class TimedTransfer(TransferManager):
+    '''GMG prolongation and restriction, timed per level.  With assembled,
+    each prolongation P is built once, at its first use, as an AIJ matrix and
+    is applied by MatMult, and restriction by MatMultTranspose; otherwise
+    Firedrake's matrix-free interpolation kernels are used.  P is built by
+    probing:  prolonging, in broken (cell-wise) copies of the spaces, the
+    coarse basis function with local index p in every coarse cell at once
+    gives the entries of column p of each coarse cell, so the number of
+    matrix-free prolongations needed is the number of nodes per cell.'''
+
+    def __init__(self, assembled):
+        super().__init__()
+        self.assembled = assembled
+        self.mats = {}
+        self.times = {}  # level -> [prolong, restrict, setup times, counts]
+
+    def level(self, V):
+        from firedrake.mg.utils import get_level
+        return get_level(V.mesh())[1]
+
+    def matrix(self, Vc, Vf):
+        '''Assemble P from Vc to Vf, using rows only from owned fine cells.'''
+        from firedrake.mg.utils import get_level
+        key = (Vc, Vf)
+        if key in self.mats:
+            return self.mats[key]
+        hierarchy, lf = get_level(Vf.mesh())
+        bs = Vf.value_size
+        scalar = lambda V: V.ufl_element().sub_elements()[0] if bs > 1 else V.ufl_element()
+        Bc = FunctionSpace(Vc.mesh(), BrokenElement(scalar(Vc)))
+        Bf = FunctionSpace(Vf.mesh(), BrokenElement(scalar(Vf)))
+        Sc = FunctionSpace(Vc.mesh(), scalar(Vc))
+        Sf = FunctionSpace(Vf.mesh(), scalar(Vf))
+        ncells = Vf.mesh().cell_set.size
+        parent = hierarchy.fine_to_coarse_cells[lf][:ncells, 0]
+        cnodes = Sc.cell_node_map().values_with_halo[parent]
+        fnodes = Sf.cell_node_map().values[:ncells]
+        bcnodes = Bc.cell_node_map().values_with_halo
+        bfnodes = Bf.cell_node_map().values[:ncells]
+        nown = Sf.dof_dset.size
+        wc, wf = Function(Bc), Function(Bf)
+        rows, cols, vals = [], [], []
+        for p in range(cnodes.shape[1]):
+            wc.dat.data_with_halos[:] = 0.0
+            wc.dat.data_with_halos[bcnodes[:, p]] = 1.0
+            prolong(wc, wf)
+            v = wf.dat.data_ro_with_halos[bfnodes]
+            c = np.broadcast_to(cnodes[:, p:p+1], v.shape)
+            keep = (fnodes < nown) & (v != 0.0)
+            rows.append(fnodes[keep])
+            cols.append(c[keep])
+            vals.append(v[keep])
+        rows, cols, vals = np.concatenate(rows), np.concatenate(cols), np.concatenate(vals)
+        # a fine node in several fine cells gives duplicate (equal) entries
+        cols = Vc.dof_dset.lgmap.applyBlock(cols)
+        order = np.lexsort((cols, rows))
+        rows, cols, vals = rows[order], cols[order], vals[order]
+        first = np.ones(len(rows), dtype=bool)
+        first[1:] = (rows[1:] != rows[:-1]) | (cols[1:] != cols[:-1])
+        rows, cols, vals = rows[first], cols[first], vals[first]
+        # expand to blocks, component by component, for vector-valued spaces
+        rows = (bs * rows[:, None] + np.arange(bs)).ravel()
+        cols = (bs * cols[:, None] + np.arange(bs)).ravel().astype(PETSc.IntType)
+        vals = np.repeat(vals, bs)
+        order = np.argsort(rows, kind='stable')
+        rows, cols, vals = rows[order], cols[order], vals[order]
+        indptr = np.zeros(bs * nown + 1, dtype=PETSc.IntType)
+        np.cumsum(np.bincount(rows, minlength=bs * nown), out=indptr[1:])
+        P = PETSc.Mat().createAIJ(((bs * nown, None), (bs * Vc.dof_dset.size, None)),
+                                  csr=(indptr, cols, vals), comm=Vf.mesh().comm)
+        self.mats[key] = P
+        return P
+
+    def timed(self, V, which, work):
+        import time
+        t = self.times.setdefault(self.level(V), [0.0, 0.0, 0.0, 0, 0])
+        t0 = time.perf_counter()
+        work()
+        t[which] += time.perf_counter() - t0
+        if which < 2:
+            t[3 + which] += 1
+
+    def prolong(self, uc, uf):
+        Vc, Vf = uc.function_space(), uf.function_space()
+        if not self.assembled:
+            return self.timed(Vf, 0, lambda: super(TimedTransfer, self).prolong(uc, uf))
+        if (Vc, Vf) not in self.mats:
+            self.timed(Vf, 2, lambda: self.matrix(Vc, Vf))
+        def work():
+            with uc.dat.vec_ro as x, uf.dat.vec_wo as y:
+                self.mats[(Vc, Vf)].mult(x, y)
+        self.timed(Vf, 0, work)
+
+    def restrict(self, source, target):
+        Vc, Vf = target.function_space(), source.function_space()
+        if not self.assembled:
+            return self.timed(Vf, 1, lambda: super(TimedTransfer, self).restrict(source, target))
+        if (Vc, Vf) not in self.mats:
+            self.timed(Vf, 2, lambda: self.matrix(Vc, Vf))
+        def work():
+            with source.dat.vec_ro as x, target.dat.vec_wo as y:
+                self.mats[(Vc, Vf)].multTranspose(x, y)
+        self.timed(Vf, 1, work)
+
+    def report(self, comm):
+        '''Per fine level:  number and time (maximum over processes) of
+        prolongations and restrictions, time per call, and, if assembled, the
+        time to build P and its nonzeros.'''
+        PETSc.Sys.Print('  %s transfers: level  prolongs  time (s)  per call  restricts  time (s)  per call  setup (s)      P nnz' \
+                        % ('assembled' if self.assembled else '  matfree'))
+        for l in sorted(self.times.keys()):
+            tp, tr, ts = [comm.allreduce(t, op=MPI.MAX) for t in self.times[l][:3]]
+            nprol, nrest = self.times[l][3:]
+            nnz = [P.getInfo(PETSc.Mat.InfoType.GLOBAL_SUM)['nz_used'] \
+                   for (Vc, Vf), P in self.mats.items() if self.level(Vf) == l]
+            PETSc.Sys.Print('  %25d %9d %9.3e %9.3e %10d %9.3e %9.3e %9.3e %10s' \
+                            % (l,nprol,tp,tp / max(nprol, 1),nrest,tr,tr / max(nrest, 1),ts,
+                               '%d' % nnz[0] if len(nnz) > 0 else '-'))
+
+transfers = {'matfree': False, 'assembled': True}
+
+def timedtransfer(choice):
+    '''The TimedTransfer for -transfer choice, or None if choice is empty.'''
+    if len(choice) == 0:
+        return None
+    if choice not in transfers:
+        print('ERROR: invalid -transfer; choices are %s' % list(transfers.keys()))
+        sys.exit(1)
+    return TimedTransfer(transfers[choice])
+
+# time in global reductions during KSPSolve
+def reductiontiming(comm):
+    '''Split the time in KSPSolve, maximum over processes, into time spent in
+    blocking global reductions (e.g. VecMDot and VecNorm in GMRES, classical
+    Gram-Schmidt or not), in waits for the split-phase reductions of
+    pipelined methods (pgmres, pipecg, ...), and the rest.'''
+    perf = lambda name: PETSc.Log.Event(name).getPerfInfo()['time']
+    times = [perf('KSPSolve'),
+             sum(perf(name) for name in ['VecDot', 'VecMDot', 'VecNorm', 'VecDotNorm2']),
+             sum(perf(name) for name in ['VecReduceComm', 'VecReduceEnd'])]
+    tsolve, tblock, twait = [comm.allreduce(t, op=MPI.MAX) for t in times]
+    pct = lambda t: 100.0 * t / max(tsolve, 1.0e-300)
+    PETSc.Sys.Print('  KSPSolve %.3e s: blocking reductions %.3e s (%.1f%%), pipelined waits %.3e s (%.1f%%), rest %.3e s' \
+                    % (tsolve,tblock,pct(tblock),twait,pct(twait),tsolve - tblock - twait))
+
+# discretization-aware stopping
+def discstoptest(hierarchy, u, order, frac, sub=None):
+    '''Return a KSP convergence test which stops once the estimated algebraic
+    error is below frac times the estimated discretization error, both
+    relative and in L^2, and a dict holding the final estimates.  The iterate
+    is w = u - du, as SNES solves for the Newton step du.  For a method of
+    order p the discretization error of w is estimated from the hierarchy as
+    |w - P I w| / (2^p - 1),  where I injects w onto the next coarser mesh
+    and P prolongs back (compare Richardson extrapolation).  The
+    algebraic error is estimated as  |w_k - w_{k-1}| rho / (1 - rho)  where rho
+    is the recent residual contraction rate.  Only component sub of a mixed
+    w is measured.'''
+    part = lambda f: f if sub is None else f.sub(sub)
+    w, wold = Function(u.function_space()), Function(u.function_space())
+    Vc = FunctionSpace(hierarchy[-2], part(w).function_space().ufl_element())
+    wc = Function(Vc)
+    wf = Function(part(w).function_space())
+    rnorms, est = [], {'alg': np.inf, 'disc': np.inf}
+    def test(ksp, its, rnorm):
+        rnorms.append(rnorm)
+        if rnorm == 0.0:
+            return PETSc.KSP.ConvergedReason.CONVERGED_ATOL
+        if its >= ksp.getTolerances()[3]:
+            return PETSc.KSP.ConvergedReason.DIVERGED_ITS
+        wold.assign(w)
+        with w.dat.vec_wo as v:
+            ksp.buildSolution().copy(v)
+        w.assign(u - w)
+        if its < 2:
+            return PETSc.KSP.ConvergedReason.ITERATING
+        m = min(its, 3)
+        rho = min((rnorms[-1] / rnorms[-1-m])**(1.0 / m), 0.99)
+        wnorm = max(norm(part(w)), 1.0e-300)
+        inject(part(w), wc)
+        prolong(wc, wf)
+        est['alg'] = errornorm(part(w), part(wold)) * rho / (1.0 - rho) / wnorm
+        est['disc'] = errornorm(part(w), wf) / (2**order - 1) / wnorm
+        if est['alg'] <= frac * est['disc']:
+            return PETSc.KSP.ConvergedReason.CONVERGED_RTOL
+        return PETSc.KSP.ConvergedReason.ITERATING
+    return test, est
+
+def discstopsolve(solver, w, test, est, compare):
+    '''Solve with the discretization-aware test; with compare, first solve
+    with the default (-s_ksp_rtol) test and report iterations and KSPSolve
+    time saved.'''
+    comm = w.function_space().mesh().comm
+    ksp = solver.snes.getKSP()
+    tksp = lambda stage: comm.allreduce(
+               PETSc.Log.Event('KSPSolve').getPerfInfo(stage.id)['time'], op=MPI.MAX)
+    PETSc.Log.begin()
+    if compare:
+        stage = PETSc.Log.Stage('rtol solve')
+        stage.push()
+        solver.solve()
+        stage.pop()
+        itsrtol, trtol = ksp.getIterationNumber(), tksp(stage)
+        w.assign(0.0)
+    ksp.setConvergenceTest(test)
+    stage = PETSc.Log.Stage('discstop solve')
+    stage.push()
+    solver.solve()
+    stage.pop()
+    its, t = ksp.getIterationNumber(), tksp(stage)
+    PETSc.Sys.Print('  discretization-aware stop after %d iterations (%.3e s): relative errors' % (its,t))
+    PETSc.Sys.Print('      algebraic ~ %.3e, discretization ~ %.3e' % (est['alg'],est['disc']))
+    if compare:
+        PETSc.Sys.Print('  -s_ksp_rtol %.1e stop after %d iterations (%.3e s); saved %d iterations, %.3e s' \
+                        % (ksp.getTolerances()[0],itsrtol,trtol,itsrtol - its,trtol - t))
+
+# halo exchange versus compute in residual assembly
+def haloreport(mesh, F, w, nrep=10):
+    '''Report the pyop2_core/owned/ghost point counts per rank, and time
+    residual and Jacobian assembly, and MatMult, in separate log stages.  In
+    each, halo wait is the time spent completing star-forest (halo)
+    communication and the rest is compute.  Assembly computes on core cells
+    before waiting for the halo, so the exchange is hidden if the (estimated)
+    core-cell compute exceeds the halo wait.'''
+    import time
+    dm = mesh.topology_dm
+    size = lambda name: dm.getStratumSize(name, 1) if dm.hasLabel(name) else 0
+    core, owned = size('pyop2_core'), size('pyop2_owned')
+    counts = mesh.comm.gather((core, owned, size('pyop2_ghost')), root=0)
+    PETSc.Sys.Print('  halo report: rank     core    owned    ghost  ghost/owned  core fraction')
+    if mesh.comm.rank == 0:
+        for rank, (c, o, g) in enumerate(counts):
+            PETSc.Sys.Print('  %17d %8d %8d %8d %12.3f %14.3f' \
+                            % (rank, c, o, g, g / max(c + o, 1), c / max(c + o, 1)))
+    # worst case over ranks
+    corefrac = mesh.comm.allreduce(core / max(core + owned, 1), op=MPI.MIN)
+    wait = lambda stage: sum(PETSc.Log.Event(name).getPerfInfo(stage.id)['time'] \
+                             for name in ['SFBcastEnd', 'SFReduceEnd'])
+    def timestage(name, work):
+        stage = PETSc.Log.Stage(name)
+        stage.push()
+        t0 = time.perf_counter()
+        for k in range(nrep):
+            work()
+        t = time.perf_counter() - t0
+        stage.pop()
+        t, tw = mesh.comm.allreduce(t, op=MPI.MAX), mesh.comm.allreduce(wait(stage), op=MPI.MAX)
+        PETSc.Sys.Print('  %-9s x %d: %.3e s, halo wait %.3e s, compute %.3e s, core-cell compute ~ %.3e s (%s)' \
+                        % (name, nrep, t, tw, t - tw, corefrac * (t - tw),
+                           'hidden' if corefrac * (t - tw) >= tw else 'NOT hidden'))
+    PETSc.Log.begin()
+    J = derivative(F, w)
+    timestage('residual', lambda: assemble(F))
+    timestage('jacobian', lambda: assemble(J, mat_type='aij'))
+    A = assemble(J, mat_type='aij').petscmat
+    x, y = A.createVecs()
+    x.set(1.0)
+    timestage('MatMult', lambda: A.mult(x, y))
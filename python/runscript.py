@@ -0,0 +1,81 @@
+'''Run ch13/fish.py, ch14/stokes.py, or another script, with its options,
+as __main__ in this process.  Shared by solverserver.py, sweep.py, and
+kernelcache.py.  Firedrake is imported at the first call, so that a caller
+may first set environment variables (e.g. cache locations).'''
+
+import os, sys, traceback, types
+
+def isnumber(s):
+    try:
+        float(s)
+        return True
+    except ValueError:
+        return False
+
+def setoptions(opts, argv):
+    '''Set PETSc options from the list argv, as PETSc parses a command line:
+    an option takes the next item as its value unless that is itself an
+    option (a negative number is a value).  Unlike joining argv into one
+    string for insertString(), this keeps values which contain spaces.'''
+    isoption = lambda a: a.startswith('-') and not isnumber(a)
+    i = 0
+    while i < len(argv):
+        if isoption(argv[i]):
+            if i + 1 < len(argv) and not isoption(argv[i+1]):
+                opts[argv[i][1:]] = argv[i+1]
+                i += 1
+            else:
+                opts[argv[i][1:]] = None
+        i += 1
+
+def runscript(argv, cwd=None, out=None, comm=None):
+    '''Run argv[0], with options argv[1:], as __main__ in directory cwd
+    (default is the current one).  If out is a file then stdout, as file
+    descriptor 1 so that PETSc output is included, goes to it.  An exception
+    in the script is printed, with its traceback, to stdout.  Such an
+    exception, and an exit with nonzero status (sys.exit(1) after 'ERROR:'),
+    are failures.  Returns the number of processes of comm on which the
+    script failed (0 or 1 if comm is None).  Process-global state which a script may change is restored
+    afterwards:  the directory, all PETSc options (from the command line or
+    set by the script, e.g. ksp_chebyshev_esteig), and the PyOP2
+    configuration (e.g. by fish.py -vectorize).'''
+    from firedrake.petsc import PETSc
+    from pyop2.configuration import configuration
+    cwd = os.getcwd() if cwd is None else cwd
+    script = os.path.abspath(os.path.join(cwd, argv[0]))
+    opts = PETSc.Options()
+    saved = sys.argv, sys.modules['__main__'], os.getcwd(), opts.getAll(), dict(configuration)
+    os.chdir(cwd)
+    setoptions(opts, argv[1:])
+    main = types.ModuleType('__main__')
+    main.__file__ = script
+    sys.argv = [script,] + argv[1:]
+    sys.modules['__main__'] = main  # so '__main__.Mass' etc. resolve
+    if out is not None:
+        sys.stdout.flush()
+        savedfd = os.dup(1)
+        os.dup2(out.fileno(), 1)
+    failed = 0
+    try:
+        exec(compile(open(script).read(), script, 'exec'), main.__dict__)
+    except SystemExit as e:
+        failed = 0 if e.code in (None, 0) else 1   # e.g. 'ERROR: invalid -X'
+    except Exception:
+        traceback.print_exc(file=sys.stdout)
+        failed = 1
+    finally:
+        sys.stdout.flush()
+        if out is not None:
+            os.dup2(savedfd, 1)
+            os.close(savedfd)
+        sys.argv, sys.modules['__main__'] = saved[0], saved[1]
+        os.chdir(saved[2])
+        for k, v in opts.getAll().items():
+            if k not in saved[3]:
+                opts.delValue(k)
+            elif v != saved[3][k]:
+                opts[k] = saved[3][k]
+        for k, v in saved[4].items():
+            if configuration.get(k) != v:
+                configuration[k] = v
+    return comm.allreduce(failed) if comm is not None else failed
@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+
+from argparse import ArgumentParser, RawTextHelpFormatter
+import json, os, socket, sys, time
+
+parser = ArgumentParser(description="""
+Persistent server for ch13/fish.py and ch14/stokes.py.  The server keeps the
+Python interpreter, Firedrake, the compiled kernels, and the meshes warm, and
+runs each requested case (a script and its options) in the same process.
+Output of each case is streamed back to the client.  For example:
+    $ mpiexec -n 4 ./solverserver.py &
+    $ ./solverserver.py -client ch13/fish.py -refine 6 -s_pc_type mg
+    $ ./solverserver.py -client ch14/stokes.py -refine 4 -schurgmg lower
+    $ ./solverserver.py -client -quit
+Run the server with the same number of processes as the cases need.  Note that
+-log_view on a case is not supported; PETSc logs cover the server lifetime.""",
+    formatter_class=RawTextHelpFormatter,allow_abbrev=False)
+parser.add_argument('-client', action='store_true', default=False,
+                    help='send the rest of the command line to the server')
+parser.add_argument('-quit', action='store_true', default=False,
+                    help='(with -client) stop the server')
+parser.add_argument('-socket', metavar='PATH', type=str,
+                    default='/tmp/p4pdes-solverserver-%d' % os.getuid(),
+                    help='local (Unix domain) socket of the server')
+args, request = parser.parse_known_args()
+
+DONE = '#solverserver done'
+
+def client():
+    '''Send a request and copy the streamed output to stdout.  Returns the
+    exit status of the case (0 if it succeeded, 1 if it failed).'''
+    if args.quit:
+        req = {'quit': True}
+    else:
+        req = {'cwd': os.getcwd(), 'argv': request}
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as s:
+        s.connect(args.socket)
+        s.sendall((json.dumps(req) + '\n').encode())
+        buf = b''
+        while True:
+            chunk = s.recv(65536)
+            if not chunk:
+                break
+            buf += chunk
+            text = buf.decode(errors='replace')
+            if DONE in text and text.endswith('\n'):
+                sys.stdout.write(text[:text.index(DONE)])
+                return int(text[text.index(DONE):].split()[2])
+        sys.stdout.write(buf.decode(errors='replace'))
+        return 0 if args.quit else 1  # server stopped before the case ended
+
+if args.client:
+    sys.exit(client())
+
+# server from here on
+from firedrake import *
+from firedrake.petsc import PETSc
+import firedrake
+from runscript import runscript
+
+comm = COMM_WORLD
+
+class MeshCache:
+    '''Memoize the mesh constructors used by the scripts.  The key includes
+    the options of the case which move coordinates (e.g. stokes.py -grade),
+    so that such a case gets its own meshes.  As a script may still move the
+    coordinates of a cached mesh, those of every cached mesh, including every
+    level of a hierarchy, are restored by restore() before each case.'''
+
+    GEOMETRY = ['-grade']  # options which move mesh coordinates
+
+    def __init__(self):
+        self.cache = {}
+        self.coords = []   # (mesh, original coordinates) for all levels
+        for name in ['UnitSquareMesh', 'Mesh', 'MeshHierarchy']:
+            setattr(firedrake, name, self.wrap(name, getattr(firedrake, name)))
+
+    def geometry(self):
+        '''Values of the GEOMETRY options of the running case.'''
+        argv = sys.argv[1:]
+        return tuple((a, argv[i+1] if i + 1 < len(argv) else None)
+                     for i, a in enumerate(argv) if a in self.GEOMETRY)
+
+    def key(self, name, a, kw):
+        def frozen(v):
+            if isinstance(v, dict):
+                return tuple(sorted((k, frozen(w)) for k, w in v.items()))
+            if isinstance(v, (list, tuple)):
+                return tuple(frozen(w) for w in v)
+            if isinstance(v, str) and os.path.isfile(v):
+                return (os.path.abspath(v), os.path.getmtime(v))
+            if isinstance(v, (int, float, str, bool, type(None))):
+                return v
+            return id(v)  # e.g. the coarse mesh for MeshHierarchy
+        return (name, frozen(a), frozen(kw), self.geometry())
+
+    def restore(self):
+        '''Reset the coordinates of every cached mesh to those it was built
+        with.'''
+        for m, c in self.coords:
+            m.coordinates.dat.data[:] = c
+
+    def wrap(self, name, constructor):
+        def cached(*a, **kw):
+            try:
+                k = self.key(name, a, kw)
+                hash(k)
+            except TypeError:
+                return constructor(*a, **kw)
+            if k in self.cache:
+                return self.cache[k]
+            result = constructor(*a, **kw)
+            self.cache[k] = result
+            known = set(id(m) for m, _ in self.coords)
+            self.coords += [(m, m.coordinates.dat.data_ro.copy())
+                            for m in self.meshes(result) if id(m) not in known]
+            return result
+        return cached
+
+    def meshes(self, result):
+        return list(result) if hasattr(result, '__len__') else [result,]
+
+meshcache = MeshCache()
+if comm.rank == 0:
+    if os.path.exists(args.socket):
+        os.remove(args.socket)
+    server = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    server.bind(args.socket)
+    server.listen(1)
+    print('solverserver listening on %s with %d processes' % (args.socket,comm.size))
+    sys.stdout.flush()
+while True:
+    if comm.rank == 0:
+        conn, _ = server.accept()
+        line = b''
+        while not line.endswith(b'\n'):
+            chunk = conn.recv(65536)
+            if not chunk:
+                break
+            line += chunk
+        req = json.loads(line.decode()) if len(line) > 0 else {'argv': []}
+    else:
+        req = None
+    req = comm.bcast(req, root=0)
+    if req.get('quit', False):
+        break
+    if len(req['argv']) == 0:
+        if comm.rank == 0:
+            conn.close()
+        continue
+    # stream rank 0 stdout, from Python and from PETSc, to the client
+    if comm.rank == 0:
+        sys.stdout.flush()
+        savedfd = os.dup(1)
+        os.dup2(conn.fileno(), 1)
+    t0 = time.perf_counter()
+    meshcache.restore()
+    # agree on errors; a case which failed on some ranks only leaves the
+    # others in an unknown state (e.g. PETSc objects not destroyed)
+    failed = runscript(req['argv'], cwd=req['cwd'], comm=comm)
+    if 0 < failed < comm.size:
+        if comm.rank == 0:
+            print('solverserver: case failed on %d of %d processes; stopping' \
+                  % (failed,comm.size))
+            sys.stdout.flush()
+        comm.Abort(1)
+    comm.Barrier()
+    if comm.rank == 0:
+        print('%s %d (%.3f s)' % (DONE,int(failed > 0),time.perf_counter() - t0))
+        sys.stdout.flush()
+        os.dup2(savedfd, 1)
+        os.close(savedfd)
+        conn.close()
+if comm.rank == 0:
+    conn.close()
+    server.close()
+    os.remove(args.socket)
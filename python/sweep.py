@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+
+from argparse import ArgumentParser, RawTextHelpFormatter
+import os, re, subprocess, sys, tempfile, time
+
+parser = ArgumentParser(description="""
+Ensemble-parallel sweep driver for ch13/fish.py and ch14/stokes.py.  Splits
+COMM_WORLD into G sub-communicators, as Firedrake's Ensemble does, and runs
+independent cases concurrently, each on its own group of processes.  Cases are
+assigned largest first to the least-loaded group, using a cost estimate from
+the grid size, refinement level, and element degrees.  Results are gathered
+into one table.  Cases are read from a file, one per line (a script and its
+options), or listed by running a study script in ch14/study/ with STOKES set
+to a command which only prints its options.  For example:
+    $ mpiexec -n 8 ./sweep.py -groups 4 -preset stokesconv
+    $ mpiexec -n 4 ./sweep.py -groups 4 -cases mycases.txt""",
+    formatter_class=RawTextHelpFormatter,allow_abbrev=False)
+parser.add_argument('-cases', metavar='FILE', type=str, default='',
+                    help='file with one case per line; # starts a comment')
+parser.add_argument('-groups', type=int, default=1, metavar='G',
+                    help='number of ensemble members (sub-communicators)')
+parser.add_argument('-preset', metavar='X', type=str, default='',
+                    help='cases from a study script: stokesconv|stokesmumats')
+parser.add_argument('-quiet', action='store_true', default=False,
+                    help='print only the table, and the output of failed cases')
+args = parser.parse_args()
+
+here = os.path.dirname(os.path.abspath(__file__))
+stokes = os.path.join(here, 'ch14', 'stokes.py')
+presets = ['stokesconv', 'stokesmumats']
+
+def preset(name):
+    '''The cases of ch14/study/name.sh, which runs ${STOKES} with the options
+    of each case:  run the script with STOKES set to echo a marker, so that
+    the presets cannot drift from the study scripts.'''
+    study = os.path.join(here, 'ch14', 'study')
+    out = subprocess.run(['bash', os.path.join(study, name + '.sh')], cwd=study,
+                         env=dict(os.environ, STOKES='echo SWEEPCASE'),
+                         stdout=subprocess.PIPE, stderr=subprocess.DEVNULL,
+                         universal_newlines=True, check=True).stdout
+    return [stokes + line[len('SWEEPCASE'):] for line in out.splitlines()
+            if line.startswith('SWEEPCASE ')]
+
+if len(args.preset) > 0:
+    if args.preset not in presets:
+        print('ERROR: invalid -preset; choices are %s' % presets)
+        sys.exit(1)
+    cases = preset(args.preset)
+else:
+    assert len(args.cases) > 0, 'one of -cases or -preset is required'
+    cases = [line.split('#')[0].strip() for line in open(args.cases)]
+    cases = [c for c in cases if len(c) > 0]
+
+def cost(case):
+    '''Relative cost estimate, proportional to the number of unknowns.'''
+    def opt(name, default):
+        m = re.search(r'-%s\s+(\S+)' % name, case)
+        return float(m.group(1)) if m else default
+    cells = (opt('mx', 3) - 1) * (opt('my', 3) - 1) * 4**max(opt('refine', 0), 0)
+    degree = max(opt('k', 1), opt('udegree', 2 if 'stokes' in case else 1))
+    return cells * degree**2
+
+def schedule(cases, G):
+    '''Largest cost first, each to the least-loaded group.'''
+    load, groupof = [0.0,] * G, [0,] * len(cases)
+    for i in sorted(range(len(cases)), key=lambda i: -cost(cases[i])):
+        g = load.index(min(load))
+        groupof[i] = g
+        load[g] += cost(cases[i])
+    return groupof, load
+
+from firedrake import *
+from firedrake.petsc import PETSc
+import firedrake
+from runscript import runscript
+
+world = COMM_WORLD
+G = max(1, min(args.groups, world.size))
+color = world.rank * G // world.size
+comm = world.Split(color, world.rank)
+groupof, load = schedule(cases, G)
+if world.rank == 0:
+    print('sweep of %d cases on %d groups of about %d processes; estimated loads %s' \
+          % (len(cases),G,world.size // G,
+             ', '.join('%.2f' % (l / max(max(load), 1.0)) for l in load)))
+    sys.stdout.flush()
+
+# meshes built by the scripts go on this group's communicator, and so does
+# PETSc.Sys.Print output
+for name in ['UnitSquareMesh', 'Mesh']:
+    def oncomm(*a, _constructor=getattr(firedrake, name), **kw):
+        kw.setdefault('comm', comm)
+        return _constructor(*a, **kw)
+    setattr(firedrake, name, oncomm)
+firedrake.COMM_WORLD = comm
+PETSc.Sys.setDefaultComm(comm)
+
+def runcase(case):
+    '''Run a case as __main__ on this group, capturing its output on the
+    group's rank 0.  A case which raises an exception is recorded as failed,
+    with the traceback in its output, and the sweep continues.'''
+    out = tempfile.TemporaryFile(mode='w+')
+    t0 = time.perf_counter()
+    failed = runscript(case.split(), out=out, comm=comm)
+    comm.Barrier()
+    t = time.perf_counter() - t0
+    out.seek(0)
+    return t, out.read(), failed > 0
+
+results = {}
+for i, case in enumerate(cases):
+    if groupof[i] == color:
+        results[i] = runcase(case)
+results = world.gather(results if comm.rank == 0 else {}, root=0)
+
+if world.rank == 0:
+    table = {}
+    for r in results:
+        table.update(r)
+    print('%5s %6s %10s %7s  %s' % ('case','group','time (s)','status','command'))
+    for i, case in enumerate(cases):
+        t, output, failed = table[i]
+        print('%5d %6d %10.3f %7s  %s' % (i,groupof[i],t,'FAILED' if failed else 'ok',
+                                         case.replace(here + '/','')))
+        if failed or not args.quiet:
+            for line in output.splitlines():
+                print('%32s%s' % ('',line))
+    nfailed = sum(failed for _, _, failed in table.values())
+    print('sum of case times %.3f s; %d of %d cases failed' \
+          % (sum(t for t, _, _ in table.values()),nfailed,len(cases)))